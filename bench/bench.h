@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace Bench
+{
+    //! Average duration of one call of fn over given number of iterations
+    template<class TFn> std::chrono::duration<double, std::micro> Measure(size_t iterations, TFn&& fn)
+    {
+        fn(); // warm up
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start) / iterations;
+    }
+
+    inline void Report(const std::string& name, std::chrono::duration<double, std::micro> duration)
+    {
+        std::cout << "[BENCH] " << std::left << std::setw(48) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << duration.count() << " us" << std::endl;
+    }
+
+    inline void Report(const std::string& name, double value, const std::string& units)
+    {
+        std::cout << "[BENCH] " << std::left << std::setw(48) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << value << " " << units << std::endl;
+    }
+}
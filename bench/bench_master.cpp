@@ -0,0 +1,94 @@
+#include "bench_master.h"
+
+#include "cs104_connection.h"
+
+namespace
+{
+    extern "C" {
+    void ConnectionHandler(void* parameter, CS104_Connection connection, CS104_ConnectionEvent event)
+    {
+        if (event == CS104_CONNECTION_STARTDT_CON_RECEIVED) {
+            ((Bench::TMaster*)parameter)->HandleActivation();
+        }
+    }
+
+    bool AsduReceivedHandler(void* parameter, int address, CS101_ASDU asdu)
+    {
+        ((Bench::TMaster*)parameter)->HandleAsdu(asdu);
+        return true;
+    }
+    }
+}
+
+int64_t Bench::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Bench::TMaster::TMaster(int port, int commonAddress, const std::vector<std::atomic<int64_t>>& sendTimes)
+    : Asdus(0),
+      Changes(0),
+      CommonAddress(commonAddress),
+      SendTimes(sendTimes),
+      GiEnd(0),
+      Active(false)
+{
+    Connection = CS104_Connection_create("127.0.0.1", port);
+    CS104_Connection_setConnectionHandler(Connection, ConnectionHandler, this);
+    CS104_Connection_setASDUReceivedHandler(Connection, AsduReceivedHandler, this);
+}
+
+Bench::TMaster::~TMaster()
+{
+    CS104_Connection_destroy(Connection);
+}
+
+bool Bench::TMaster::Connect(std::chrono::steady_clock::duration timeout)
+{
+    if (!CS104_Connection_connect(Connection)) {
+        return false;
+    }
+    CS104_Connection_sendStartDT(Connection);
+    return WaitFor(timeout, [this]() { return Active.load(); });
+}
+
+std::chrono::microseconds Bench::TMaster::Interrogate(std::chrono::steady_clock::duration timeout)
+{
+    GiEnd = 0;
+    auto start = Now();
+    CS104_Connection_sendInterrogationCommand(Connection, CS101_COT_ACTIVATION, CommonAddress, IEC60870_QOI_STATION);
+    if (!WaitFor(timeout, [this]() { return GiEnd.load() != 0; })) {
+        return std::chrono::microseconds::max();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(GiEnd - start));
+}
+
+void Bench::TMaster::HandleActivation()
+{
+    Active = true;
+}
+
+void Bench::TMaster::HandleAsdu(CS101_ASDU asdu)
+{
+    auto now = Now();
+    if (CS101_ASDU_getTypeID(asdu) == C_IC_NA_1) {
+        if (CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION_TERMINATION) {
+            GiEnd = now;
+        }
+        return;
+    }
+    if (CS101_ASDU_getCOT(asdu) != CS101_COT_SPONTANEOUS || CS101_ASDU_getTypeID(asdu) != M_ME_NC_1) {
+        return;
+    }
+    ++Asdus;
+    for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+        auto io = CS101_ASDU_getElement(asdu, i);
+        auto value = MeasuredValueShort_getValue((MeasuredValueShort)io);
+        InformationObject_destroy(io);
+        if (value >= 0 && value < SendTimes.size()) {
+            Latency.Add(std::chrono::nanoseconds(now - SendTimes[static_cast<size_t>(value)]));
+            ++Changes;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.h"
+
+struct sCS104_Connection;
+struct sCS101_ASDU;
+
+namespace Bench
+{
+    //! Monotonic time in nanoseconds
+    int64_t Now();
+
+    //! Poll predicate until it is true. Returns false on timeout
+    template<class TPredicate> bool WaitFor(std::chrono::steady_clock::duration timeout, TPredicate pred)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!pred()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    /**
+     * @brief CS104 master connected over loopback. Receives spontaneous measured values short.
+     *        Values are treated as indices in send times array to calculate end-to-end latency.
+     *        Negative values are ignored.
+     */
+    class TMaster
+    {
+    public:
+        TLatencyHistogram Latency;
+        std::atomic<uint64_t> Asdus;
+        std::atomic<uint64_t> Changes;
+
+        TMaster(int port, int commonAddress, const std::vector<std::atomic<int64_t>>& sendTimes);
+        ~TMaster();
+
+        TMaster(const TMaster&) = delete;
+        TMaster& operator=(const TMaster&) = delete;
+
+        //! Connect and activate data transfer
+        bool Connect(std::chrono::steady_clock::duration timeout);
+
+        //! Station interrogation duration. Returns microseconds::max() on timeout
+        std::chrono::microseconds Interrogate(std::chrono::steady_clock::duration timeout);
+
+        // lib60870 callbacks
+        void HandleActivation();
+        void HandleAsdu(sCS101_ASDU* asdu);
+
+    private:
+        sCS104_Connection* Connection;
+        int CommonAddress;
+        const std::vector<std::atomic<int64_t>>& SendTimes;
+        std::atomic<int64_t> GiEnd;
+        std::atomic<bool> Active;
+    };
+}
@@ -0,0 +1,127 @@
+#include "address_assigner.h"
+#include "config_parser.h"
+
+#include <gtest/gtest.h>
+#include <set>
+#include <wblib/testing/fake_mqtt.h>
+#include <wblib/testing/testlog.h>
+
+#include "bench.h"
+
+using namespace WBMQTT;
+
+namespace
+{
+    const size_t DEVICES_COUNT = 500;
+    const size_t CONTROLS_PER_DEVICE = 100;
+
+    std::string GetDeviceId(size_t device)
+    {
+        return "wb-device_" + std::to_string(device);
+    }
+
+    std::string GetControlId(size_t control)
+    {
+        return "Channel " + std::to_string(control);
+    }
+
+    //! Former implementation with occupied addresses in std::set, the hash function doesn't matter for comparison
+    class TSetAddressAssigner
+    {
+        std::set<uint32_t> UsedAddresses;
+
+    public:
+        uint32_t GetAddress(const std::string& topic)
+        {
+            uint32_t newAddr = std::hash<std::string>()(topic) & 0xFFFFFF;
+            while (UsedAddresses.count(newAddr)) {
+                newAddr = (newAddr + 7079) & 0xFFFFFF;
+            }
+            UsedAddresses.insert(newAddr);
+            return newAddr;
+        }
+    };
+}
+
+TEST(TConfigUpdateBench, AddressAssignment)
+{
+    std::vector<std::string> topics;
+    for (size_t d = 0; d < DEVICES_COUNT; ++d) {
+        for (size_t c = 0; c < CONTROLS_PER_DEVICE; ++c) {
+            topics.push_back(GetDeviceId(d) + "/" + GetControlId(c));
+        }
+    }
+    const std::string suffix = " (" + std::to_string(topics.size()) + " controls)";
+    uint64_t sum = 0;
+    Bench::Report("std::set assigner" + suffix, Bench::Measure(3, [&]() {
+                      TSetAddressAssigner assigner;
+                      for (const auto& topic: topics) {
+                          sum += assigner.GetAddress(topic);
+                      }
+                  }));
+    Bench::Report("Bitmap assigner" + suffix, Bench::Measure(3, [&]() {
+                      TAddressAssigner assigner;
+                      for (const auto& topic: topics) {
+                          sum += assigner.GetAddress(topic);
+                      }
+                  }));
+    ASSERT_NE(sum, 0);
+}
+
+class TConfigUpdateBench: public Testing::TLoggedFixture
+{
+protected:
+    PDeviceDriver Driver;
+
+    void SetUp()
+    {
+        auto mqttBroker = Testing::NewFakeMqttBroker(*this);
+        auto backend = NewDriverBackend(mqttBroker->MakeClient("bench"));
+        Driver = NewDriver(TDriverArgs{}.SetId("bench").SetBackend(backend));
+        Driver->StartLoop();
+        Driver->WaitForReady();
+    }
+
+    void TearDown()
+    {
+        // Fake broker log is not compared to golden file
+        Driver->StopLoop();
+    }
+
+    void AddDevices(size_t first, size_t last)
+    {
+        auto tx = Driver->BeginTx();
+        for (size_t d = first; d < last; ++d) {
+            auto device = tx->CreateDevice(TLocalDeviceArgs{}.SetId(GetDeviceId(d))).GetValue();
+            for (size_t c = 0; c < CONTROLS_PER_DEVICE; ++c) {
+                device->CreateControl(tx, TControlArgs{}.SetId(GetControlId(c)).SetType("value").SetValue(c))
+                    .GetValue();
+            }
+        }
+        tx->End();
+    }
+
+    void MeasureUpdate(size_t devicesCount)
+    {
+        Json::Value config(Json::objectValue);
+        config["groups"] = Json::Value(Json::arrayValue);
+        auto start = std::chrono::steady_clock::now();
+        UpdateConfig(Driver, config);
+        std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+        ASSERT_EQ(config["groups"].size(), devicesCount);
+
+        // Time per control must not grow with size of the tree
+        const auto controlsCount = devicesCount * CONTROLS_PER_DEVICE;
+        const std::string suffix = " (" + std::to_string(controlsCount) + " controls)";
+        Bench::Report("UpdateConfig" + suffix, duration);
+        Bench::Report("UpdateConfig per control" + suffix, duration / controlsCount);
+    }
+};
+
+TEST_F(TConfigUpdateBench, UpdateConfig)
+{
+    AddDevices(0, DEVICES_COUNT / 10);
+    MeasureUpdate(DEVICES_COUNT / 10);
+    AddDevices(DEVICES_COUNT / 10, DEVICES_COUNT);
+    MeasureUpdate(DEVICES_COUNT);
+}
@@ -0,0 +1,151 @@
+// End-to-end benchmark: MQTT changes are published to fake broker, the gateway forwards them
+// through IEC 60870-5-104 server to CS104 masters connected over loopback.
+//
+// Load is configured by environment variables:
+//   BENCH_E2E_POINTS      - number of configured controls (default 1000)
+//   BENCH_E2E_RATE        - MQTT changes per second (default 5000)
+//   BENCH_E2E_DURATION_S  - load duration in seconds (default 5)
+//   BENCH_E2E_MASTERS     - number of connected masters (default 2)
+//   BENCH_E2E_COALESCE_MS - coalescing window of spontaneous changes (default 0)
+//   BENCH_E2E_PORT        - TCP port of IEC server (default 22404)
+
+#include "gateway.h"
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+#include <wblib/testing/fake_mqtt.h>
+#include <wblib/testing/testlog.h>
+
+#include "bench.h"
+#include "bench_master.h"
+
+using namespace WBMQTT;
+
+namespace
+{
+    const int COMMON_ADDRESS = 1;
+    const auto CONNECT_TIMEOUT = std::chrono::seconds(5);
+    const auto RECEIVE_TIMEOUT = std::chrono::seconds(5);
+    const auto NO_PROGRESS_TIMEOUT = std::chrono::milliseconds(500);
+
+    size_t GetEnv(const char* name, size_t defaultValue)
+    {
+        auto value = std::getenv(name);
+        return value ? std::stoul(value) : defaultValue;
+    }
+}
+
+class TEndToEndBench: public Testing::TLoggedFixture
+{
+protected:
+    PDeviceDriver Driver;
+
+    void SetUp()
+    {
+        auto mqttBroker = Testing::NewFakeMqttBroker(*this);
+        auto backend = NewDriverBackend(mqttBroker->MakeClient("bench"));
+        Driver = NewDriver(TDriverArgs{}.SetId("bench").SetBackend(backend));
+        Driver->StartLoop();
+        Driver->WaitForReady();
+    }
+
+    void TearDown()
+    {
+        // Fake broker log is not compared to golden file
+    }
+};
+
+TEST_F(TEndToEndBench, SpontaneousChanges)
+{
+    const size_t pointsCount = GetEnv("BENCH_E2E_POINTS", 1000);
+    const size_t rate = GetEnv("BENCH_E2E_RATE", 5000);
+    const size_t duration = GetEnv("BENCH_E2E_DURATION_S", 5);
+    const size_t mastersCount = GetEnv("BENCH_E2E_MASTERS", 2);
+    const int port = GetEnv("BENCH_E2E_PORT", 22404);
+
+    TDeviceConfig config;
+    std::vector<PControl> controls;
+    {
+        auto tx = Driver->BeginTx();
+        auto device = tx->CreateDevice(TLocalDeviceArgs{}.SetId("bench")).GetValue();
+        for (size_t i = 0; i < pointsCount; ++i) {
+            auto id = "c" + std::to_string(i);
+            controls.push_back(
+                device->CreateControl(tx, TControlArgs{}.SetId(id).SetType("value").SetValue(-1)).GetValue());
+            config["bench"].insert({id, {uint32_t(i + 1), MeasuredValueShort}});
+        }
+        tx->End();
+    }
+
+    IEC104::TServerConfig serverConfig;
+    serverConfig.BindIp = "127.0.0.1";
+    serverConfig.BindPort = port;
+    serverConfig.CommonAddress = COMMON_ADDRESS;
+    serverConfig.CoalesceWindow = std::chrono::milliseconds(GetEnv("BENCH_E2E_COALESCE_MS", 0));
+    auto server = IEC104::MakeServer(serverConfig);
+    TGateway gateway(Driver, server.get(), config);
+
+    const size_t changesCount = rate * duration;
+    std::vector<std::atomic<int64_t>> sendTimes(changesCount);
+
+    std::vector<std::unique_ptr<Bench::TMaster>> masters;
+    for (size_t i = 0; i < mastersCount; ++i) {
+        masters.emplace_back(new Bench::TMaster(port, COMMON_ADDRESS, sendTimes));
+        ASSERT_TRUE(masters.back()->Connect(CONNECT_TIMEOUT));
+    }
+
+    const std::string suffix = " (" + std::to_string(pointsCount) + " points)";
+    Bench::Report("GI duration, idle" + suffix, masters.front()->Interrogate(RECEIVE_TIMEOUT));
+
+    std::thread giThread([&]() {
+        std::this_thread::sleep_for(std::chrono::seconds(duration) / 2);
+        Bench::Report("GI duration, under load" + suffix, masters.front()->Interrogate(RECEIVE_TIMEOUT));
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    auto period = std::chrono::nanoseconds(std::chrono::seconds(1)) / rate;
+    for (size_t seq = 0; seq < changesCount; ++seq) {
+        std::this_thread::sleep_until(start + period * seq);
+        auto tx = Driver->BeginTx();
+        sendTimes[seq] = Bench::Now();
+        controls[seq % pointsCount]->SetValue(tx, double(seq)).Sync();
+        tx->End();
+    }
+    auto publishTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    giThread.join();
+
+    // Wait for the tail of changes until all are received or there is no progress
+    uint64_t received = 0;
+    auto lastProgress = std::chrono::steady_clock::now();
+    Bench::WaitFor(RECEIVE_TIMEOUT, [&]() {
+        uint64_t r = 0;
+        for (const auto& master: masters) {
+            r += master->Changes;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (r != received) {
+            received = r;
+            lastProgress = now;
+        }
+        return (r == changesCount * masters.size()) || (now - lastProgress > NO_PROGRESS_TIMEOUT);
+    });
+    auto receiveTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Bench::Report("MQTT changes published", changesCount, "");
+    Bench::Report("MQTT publish rate", changesCount / publishTime, "1/s");
+    for (size_t i = 0; i < masters.size(); ++i) {
+        const auto& master = *masters[i];
+        const std::string prefix = "Master " + std::to_string(i) + " ";
+        Bench::Report(prefix + "ASDUs/s", master.Asdus / receiveTime, "1/s");
+        Bench::Report(prefix + "changes received", master.Changes, "");
+        Bench::Report(prefix + "changes lost or coalesced", changesCount - master.Changes, "");
+        Bench::Report(prefix + "latency p50", master.Latency.GetPercentile(50));
+        Bench::Report(prefix + "latency p90", master.Latency.GetPercentile(90));
+        Bench::Report(prefix + "latency p99", master.Latency.GetPercentile(99));
+        Bench::Report(prefix + "latency max", master.Latency.GetMax());
+    }
+
+    masters.clear();
+    gateway.Stop();
+}
@@ -0,0 +1,211 @@
+#include "information_object_encoder.h"
+#include "interrogation_image.h"
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+namespace
+{
+    sCS101_AppLayerParameters AppLayerParameters = {
+        /* sizeOfTypeId */ 1,
+        /* sizeOfVSQ */ 1,
+        /* sizeOfCOT */ 2,
+        /* originatorAddress */ 0,
+        /* sizeOfCA */ 2,
+        /* sizeOfIOA */ 3,
+        /* maxSizeOfASDU */ 249};
+
+    const int COMMON_ADDRESS = 1;
+
+    //! Synthetic set of information objects evenly distributed between all supported types
+    IEC104::TInformationObjects MakeObjects(size_t count)
+    {
+        IEC104::TInformationObjects objs;
+        auto now = std::chrono::system_clock::now();
+        for (uint32_t ioa = 1; ioa <= count; ++ioa) {
+            switch (ioa % 6) {
+                case 0:
+                    objs.SinglePoint.emplace_back(ioa, ioa % 2);
+                    break;
+                case 1:
+                    objs.MeasuredValueShort.emplace_back(ioa, ioa * 0.1f);
+                    break;
+                case 2:
+                    objs.MeasuredValueScaled.emplace_back(ioa, ioa % 32768);
+                    break;
+                case 3:
+                    objs.SinglePointWithTimestamp.emplace_back(ioa, now, ioa % 2);
+                    break;
+                case 4:
+                    objs.MeasuredValueShortWithTimestamp.emplace_back(ioa, now, ioa * 0.1f);
+                    break;
+                case 5:
+                    objs.MeasuredValueScaledWithTimestamp.emplace_back(ioa, now, ioa % 32768);
+                    break;
+            }
+        }
+        return objs;
+    }
+
+    // Reference implementation: every interrogation encodes all information objects from scratch
+    // allocating every information object and ASDU on heap
+
+    InformationObject CreateInformationObject(const IEC104::TSinglePointInformationObject& obj)
+    {
+        return (InformationObject)SinglePointInformation_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD);
+    }
+
+    InformationObject CreateInformationObject(const IEC104::TMeasuredValueShortInformationObject& obj)
+    {
+        return (InformationObject)MeasuredValueShort_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD);
+    }
+
+    InformationObject CreateInformationObject(const IEC104::TMeasuredValueScaledInformationObject& obj)
+    {
+        return (InformationObject)MeasuredValueScaled_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD);
+    }
+
+    InformationObject CreateInformationObject(const IEC104::TSinglePointInformationObjectWithTimestamp& obj)
+    {
+        auto timestamp = IEC104::MakeTimestamp(obj.Timestamp);
+        return (InformationObject)
+            SinglePointWithCP56Time2a_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD, &timestamp);
+    }
+
+    InformationObject CreateInformationObject(const IEC104::TMeasuredValueShortInformationObjectWithTimestamp& obj)
+    {
+        auto timestamp = IEC104::MakeTimestamp(obj.Timestamp);
+        return (InformationObject)
+            MeasuredValueShortWithCP56Time2a_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD, &timestamp);
+    }
+
+    InformationObject CreateInformationObject(const IEC104::TMeasuredValueScaledInformationObjectWithTimestamp& obj)
+    {
+        auto timestamp = IEC104::MakeTimestamp(obj.Timestamp);
+        return (InformationObject)
+            MeasuredValueScaledWithCP56Time2a_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD, &timestamp);
+    }
+
+    template<class T> void EncodeFromScratch(const std::vector<T>& objs, size_t& asduCount)
+    {
+        CS101_ASDU asdu =
+            CS101_ASDU_create(&AppLayerParameters, false, CS101_COT_INTERROGATED_BY_STATION, 0, COMMON_ADDRESS, false, false);
+        for (const auto& obj: objs) {
+            auto io = CreateInformationObject(obj);
+            if (!CS101_ASDU_addInformationObject(asdu, io)) {
+                ++asduCount;
+                CS101_ASDU_destroy(asdu);
+                asdu = CS101_ASDU_create(&AppLayerParameters,
+                                         false,
+                                         CS101_COT_INTERROGATED_BY_STATION,
+                                         0,
+                                         COMMON_ADDRESS,
+                                         false,
+                                         false);
+                CS101_ASDU_addInformationObject(asdu, io);
+            }
+            InformationObject_destroy(io);
+        }
+        if (CS101_ASDU_getPayloadSize(asdu)) {
+            ++asduCount;
+        }
+        CS101_ASDU_destroy(asdu);
+    }
+
+    size_t EncodeFromScratch(const IEC104::TInformationObjects& objs)
+    {
+        size_t asduCount = 0;
+        EncodeFromScratch(objs.SinglePoint, asduCount);
+        EncodeFromScratch(objs.MeasuredValueShort, asduCount);
+        EncodeFromScratch(objs.MeasuredValueScaled, asduCount);
+        EncodeFromScratch(objs.SinglePointWithTimestamp, asduCount);
+        EncodeFromScratch(objs.MeasuredValueShortWithTimestamp, asduCount);
+        EncodeFromScratch(objs.MeasuredValueScaledWithTimestamp, asduCount);
+        return asduCount;
+    }
+
+    void BenchmarkInterrogation(size_t pointsCount)
+    {
+        auto objs = MakeObjects(pointsCount);
+        const size_t iterations = 20;
+        const std::string suffix = " (" + std::to_string(pointsCount) + " points)";
+
+        size_t scratchAsduCount = 0;
+        auto scratch = Bench::Measure(iterations, [&]() { scratchAsduCount = EncodeFromScratch(objs); });
+        Bench::Report("GI encode from scratch" + suffix, scratch);
+
+        size_t writerAsduCount = 0;
+        auto writer = Bench::Measure(iterations, [&]() {
+            writerAsduCount = 0;
+            IEC104::Send(&AppLayerParameters,
+                         COMMON_ADDRESS,
+                         CS101_COT_INTERROGATED_BY_STATION,
+                         objs,
+                         [&](CS101_ASDU) { ++writerAsduCount; });
+        });
+        Bench::Report("GI encode from scratch, no allocations" + suffix, writer);
+
+        IEC104::TInterrogationImage image(&AppLayerParameters);
+        auto build = Bench::Measure(1, [&]() { image.Update(objs); });
+        Bench::Report("GI image build" + suffix, build);
+
+        size_t imageAsduCount = 0;
+        auto fromImage = Bench::Measure(iterations, [&]() {
+            imageAsduCount = 0;
+            image.Send(CS101_COT_INTERROGATED_BY_STATION, COMMON_ADDRESS, [&](CS101_ASDU) { ++imageAsduCount; });
+        });
+        Bench::Report("GI encode from image" + suffix, fromImage);
+        Bench::Report("GI speedup" + suffix, scratch / fromImage, "x");
+
+        IEC104::TInformationObjects changed;
+        changed.MeasuredValueShort.assign(objs.MeasuredValueShort.begin(),
+                                          objs.MeasuredValueShort.begin() +
+                                              std::min<size_t>(100, objs.MeasuredValueShort.size()));
+        auto patch = Bench::Measure(iterations, [&]() { image.Update(changed); });
+        Bench::Report("GI image patch of 100 points" + suffix, patch);
+
+        ASSERT_EQ(image.Size(), pointsCount);
+        ASSERT_EQ(writerAsduCount, scratchAsduCount);
+        ASSERT_LE(imageAsduCount, scratchAsduCount);
+    }
+}
+
+TEST(TInterrogationBench, Points10k)
+{
+    BenchmarkInterrogation(10000);
+}
+
+TEST(TInterrogationBench, Points50k)
+{
+    BenchmarkInterrogation(50000);
+}
+
+TEST(TInterrogationBench, Sequences)
+{
+    // Measured values of consecutive addresses, as they are usually assigned to registers of a device
+    IEC104::TInformationObjects objs;
+    for (uint32_t ioa = 1; ioa <= 50000; ++ioa) {
+        objs.MeasuredValueShort.emplace_back(ioa, ioa * 0.1f);
+    }
+    const size_t iterations = 20;
+
+    for (bool sequenceEncoding: {false, true}) {
+        IEC104::TInterrogationImage image(&AppLayerParameters, {}, sequenceEncoding);
+        image.Update(objs);
+        size_t asduCount = 0;
+        size_t bytes = 0;
+        auto duration = Bench::Measure(iterations, [&]() {
+            asduCount = 0;
+            bytes = 0;
+            image.Send(CS101_COT_INTERROGATED_BY_STATION, COMMON_ADDRESS, [&](CS101_ASDU asdu) {
+                ++asduCount;
+                bytes += CS101_ASDU_getPayloadSize(asdu);
+            });
+        });
+        const std::string suffix = sequenceEncoding ? " SQ=1 (50000 floats)" : " SQ=0 (50000 floats)";
+        Bench::Report("GI encode from image" + suffix, duration);
+        Bench::Report("GI response size" + suffix, asduCount, "ASDU");
+        Bench::Report("GI payload" + suffix, bytes / 1024.0, "KiB");
+    }
+}
@@ -0,0 +1,103 @@
+#include "point_index.h"
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+namespace
+{
+    const size_t DEVICES_COUNT = 200;
+    const size_t CONTROLS_PER_DEVICE = 100;
+
+    TDeviceConfig MakeConfig(uint32_t ioaStep)
+    {
+        TDeviceConfig config;
+        uint32_t ioa = 1;
+        for (size_t d = 0; d < DEVICES_COUNT; ++d) {
+            auto& controls = config["wb-device_" + std::to_string(d)];
+            for (size_t c = 0; c < CONTROLS_PER_DEVICE; ++c) {
+                controls.insert({"Channel " + std::to_string(c), {ioa, MeasuredValueShort}});
+                ioa += ioaStep;
+            }
+        }
+        return config;
+    }
+
+    //! MQTT messages in random order
+    std::vector<TControlDesc> MakeRequests(const TDeviceConfig& config)
+    {
+        std::vector<TControlDesc> requests;
+        for (const auto& device: config) {
+            for (const auto& control: device.second) {
+                requests.push_back({device.first, control.first});
+            }
+        }
+        for (size_t i = 0; i < requests.size(); ++i) {
+            std::swap(requests[i], requests[(i * 7919) % requests.size()]);
+        }
+        return requests;
+    }
+
+    void BenchmarkLookup(uint32_t ioaStep, const std::string& suffix)
+    {
+        auto config = MakeConfig(ioaStep);
+        auto requests = MakeRequests(config);
+        const size_t iterations = 20;
+
+        // Reference implementation: tree lookups
+        std::map<uint32_t, TControlDesc> ioaToControls;
+        for (const auto& device: config) {
+            for (const auto& control: device.second) {
+                ioaToControls[control.second.Address] = {device.first, control.first};
+            }
+        }
+
+        size_t found = 0;
+        auto mapControls = Bench::Measure(iterations, [&]() {
+            for (const auto& r: requests) {
+                auto itDevice = config.find(r.Device);
+                if (itDevice != config.end()) {
+                    found += itDevice->second.count(r.Control);
+                }
+            }
+        });
+        auto mapIoas = Bench::Measure(iterations, [&]() {
+            for (uint32_t ioa = 1; ioa <= requests.size() * ioaStep; ioa += ioaStep) {
+                found += ioaToControls.count(ioa);
+            }
+        });
+
+        TPointIndex index(config);
+        size_t indexFound = 0;
+        auto indexControls = Bench::Measure(iterations, [&]() {
+            for (const auto& r: requests) {
+                auto slots = index.Find(r.Device, r.Control);
+                indexFound += slots.Last - slots.First;
+            }
+        });
+        auto indexIoas = Bench::Measure(iterations, [&]() {
+            for (uint32_t ioa = 1; ioa <= requests.size() * ioaStep; ioa += ioaStep) {
+                indexFound += (index.Find(ioa) != TPointIndex::NO_SLOT);
+            }
+        });
+
+        const double count = requests.size();
+        Bench::Report("Control lookup, std::map" + suffix, mapControls.count() * 1000 / count, "ns");
+        Bench::Report("Control lookup, index" + suffix, indexControls.count() * 1000 / count, "ns");
+        Bench::Report("IOA lookup, std::map" + suffix, mapIoas.count() * 1000 / count, "ns");
+        Bench::Report("IOA lookup, index" + suffix, indexIoas.count() * 1000 / count, "ns");
+
+        ASSERT_EQ(found, indexFound);
+        ASSERT_EQ(indexFound, requests.size() * 2 * (iterations + 1));
+    }
+}
+
+TEST(TPointIndexBench, DenseAddresses20k)
+{
+    BenchmarkLookup(1, " (20k points, dense IOA)");
+}
+
+TEST(TPointIndexBench, SparseAddresses20k)
+{
+    BenchmarkLookup(701, " (20k points, sparse IOA)");
+}
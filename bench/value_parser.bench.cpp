@@ -0,0 +1,97 @@
+#include "value_parser.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+#include "bench.h"
+
+namespace
+{
+    const size_t VALUES_COUNT = 1000000;
+
+    std::vector<std::string> MakeValues(bool valid)
+    {
+        std::vector<std::string> values;
+        values.reserve(VALUES_COUNT);
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            if (valid) {
+                values.push_back(std::to_string(int(i % 20000) - 10000) + "." + std::to_string(i % 1000));
+            } else {
+                values.push_back("error " + std::to_string(i % 100));
+            }
+        }
+        return values;
+    }
+
+    void BenchmarkParsing(bool valid, const std::string& suffix)
+    {
+        auto values = MakeValues(valid);
+        const size_t iterations = 3;
+
+        // Reference implementation: standard conversions with exceptions
+        size_t errors = 0;
+        double sum = 0;
+        auto stdFloat = Bench::Measure(iterations, [&]() {
+            for (const auto& v: values) {
+                try {
+                    sum += std::stof(v);
+                } catch (const std::exception&) {
+                    ++errors;
+                }
+            }
+        });
+        auto stdInt = Bench::Measure(iterations, [&]() {
+            for (const auto& v: values) {
+                try {
+                    sum += std::stoi(v);
+                } catch (const std::exception&) {
+                    ++errors;
+                }
+            }
+        });
+
+        size_t parserErrors = 0;
+        double parserSum = 0;
+        auto parserFloat = Bench::Measure(iterations, [&]() {
+            for (const auto& v: values) {
+                float f;
+                if (ValueParser::ParseFloat(v, f) == TParseResult::Ok) {
+                    parserSum += f;
+                } else {
+                    ++parserErrors;
+                }
+            }
+        });
+        auto parserInt = Bench::Measure(iterations, [&]() {
+            for (const auto& v: values) {
+                int32_t i;
+                if (ValueParser::ParseInt(v, i) == TParseResult::Ok) {
+                    parserSum += i;
+                } else {
+                    ++parserErrors;
+                }
+            }
+        });
+
+        Bench::Report("1M floats, std::stof" + suffix, stdFloat);
+        Bench::Report("1M floats, ValueParser" + suffix, parserFloat);
+        Bench::Report("1M ints, std::stoi" + suffix, stdInt);
+        Bench::Report("1M ints, ValueParser" + suffix, parserInt);
+
+        ASSERT_EQ(errors, parserErrors);
+        if (valid) {
+            ASSERT_EQ(errors, 0);
+        }
+    }
+}
+
+TEST(TValueParserBench, ValidValues)
+{
+    BenchmarkParsing(true, " (valid)");
+}
+
+TEST(TValueParserBench, InvalidValues)
+{
+    BenchmarkParsing(false, " (invalid)");
+}
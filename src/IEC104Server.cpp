@@ -1,7 +1,13 @@
 #include "IEC104Server.h"
 
-#include <functional>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 
 #include "cs104_slave.h"
 #include "iec60870_slave.h"
@@ -9,33 +15,167 @@
 #include "hal_thread.h"
 #include "hal_time.h"
 
+#include "command_selections.h"
+#include "counters.h"
+#include "cyclic_transmission.h"
+#include "event_journal.h"
+#include "information_object_encoder.h"
+#include "interrogation_image.h"
 #include "log.h"
-
-using namespace std::chrono;
+#include "spontaneous_buffer.h"
+#include "stations.h"
+#include "statistics.h"
 
 #define LOG(logger) ::logger.Log() << "[IEC] "
 
 namespace
 {
+    // Journal records of the same type replayed in one ASDU.
+    // Must fit to a single ASDU, so partially sent chunks are not possible
+    const size_t REPLAY_CHUNK_SIZE = 8;
+
+    // Delay before next replay attempt if connection queue is full
+    const auto REPLAY_RETRY_INTERVAL = std::chrono::milliseconds(10);
+
+    // Request and freeze parts of qualifier of counter interrogation command
+    const uint8_t QCC_RQT_MASK = 0x3F;
+    const uint8_t QCC_FRZ_MASK = 0xC0;
+
+    //! Command received from IEC master and waiting for execution by handler
+    struct TCommand
+    {
+        IMasterConnection Connection;
+        std::unique_ptr<sCS101_StaticASDU> AsduBuffer; // Copy of received ASDU for confirmation
+        CS101_ASDU Asdu;
+        std::vector<IEC104::TCommandValue> Values; // All information objects of the ASDU
+        std::chrono::steady_clock::time_point ReceiveTime;
+    };
+
+    //! Commands of one connection executed in order of receiving by the connection's own thread
+    struct TCommandWorker
+    {
+        std::deque<TCommand> Commands;
+        size_t Pending = 0; // Queued and executing commands
+        bool Stop = false;
+        std::condition_variable Cv;
+        std::thread Thread;
+    };
+
+    void SetIntValue(IEC104::TCommandValue& command, int64_t value)
+    {
+        command.ValueSize = ValueFormatter::FormatInt(value, command.Value.data());
+    }
+
+    void SetFloatValue(IEC104::TCommandValue& command, float value)
+    {
+        command.ValueSize = ValueFormatter::FormatFloat(value, command.Value.data());
+    }
+
     class TServerImpl: public IEC104::IServer
     {
         CS104_Slave Slave;
         CS101_AppLayerParameters AppLayerParameters;
-        uint32_t CommonAddress;
         IEC104::IHandler* Handler;
 
+        //! Queues of redundancy groups. lib60870 doesn't expose fill of queues of connections
+        //! without redundancy groups, so their overflows aren't counted
+        size_t QueueSize;
+        std::vector<CS104_RedundancyGroup> RedundancyGroups;
+
+        //! Put ASDU to queues of connections or redundancy groups and count ASDUs pushed out of full queues
+        void Enqueue(CS101_ASDU asdu);
+
+        //! Stations (common addresses) of information objects. It is replaced as a whole on reconfiguration,
+        //! so readers take a copy of the pointer with std::atomic_load
+        std::shared_ptr<const IEC104::TStations> Stations;
+
+        //! Pre-encoded values for interrogation responses of every station. Patched on every spontaneous transmission
+        typedef std::map<uint16_t, std::unique_ptr<IEC104::TInterrogationImage>> TImages;
+        TImages Images;
+        std::mutex ImageMutex;
+
+        TImages MakeImages(const IEC104::TServerConfig& config,
+                           const IEC104::TStations& stations,
+                           const IEC104::TInformationObjects& objs) const;
+
+        //! Current and frozen counter readings of every station for counter interrogation
+        std::map<uint16_t, IEC104::TCounters> Counters;
+        std::mutex CountersMutex;
+
+        //! Get common addresses of stations addressed by interrogation command, including broadcast address.
+        //! Command with unknown common address gets negative confirmation
+        bool GetInterrogatedStations(IMasterConnection connection, CS101_ASDU asdu, std::vector<uint16_t>& res);
+
+        //! Periodic transmission of measured values
+        std::unique_ptr<IEC104::TCyclicTransmission> Cyclic;
+        std::mutex CyclicMutex;
+        std::condition_variable CyclicCv;
+        std::thread CyclicThread;
+        bool StopCyclicThread;
+
+        void CyclicLoop();
+        void StartCyclicLoop();
+
+        std::chrono::milliseconds CoalesceWindow;
+        size_t CoalesceMaxObjects;
+        IEC104::TSpontaneousBuffer PendingObjects;
+        std::mutex PendingObjectsMutex;
+        std::condition_variable PendingObjectsCv;
+        std::thread FlushThread;
+        bool StopFlushThread;
+
+        void FlushLoop();
+        void EnqueueSpontaneous(const IEC104::TInformationObjects& objs);
+
+        //! Commands of every connection are executed by a separate thread, so slow MQTT publishing
+        //! doesn't block connection threads and commands of other connections
+        size_t MaxPendingCommands;
+        bool SendActTerm;
+        std::unordered_map<IMasterConnection, uint64_t> ConnectionIds;          // Open connections
+        std::unordered_map<uint64_t, std::shared_ptr<TCommandWorker>> Workers; // Started on first command
+        IEC104::TCommandSelections Selections;                                  // Select-before-operate state
+        uint64_t NextConnectionId;
+        std::mutex CommandsMutex;
+        bool StopCommandWorkers;
+
+        void CommandLoop(TCommandWorker& worker);
+        void ExecuteCommand(TCommandWorker& worker, TCommand& command);
+        bool EnqueueCommand(IMasterConnection connection,
+                            CS101_ASDU asdu,
+                            std::vector<IEC104::TCommandValue>&& values);
+        bool SelectCommand(IMasterConnection connection, const std::vector<IEC104::TCommandValue>& values);
+        void DeselectCommand(IMasterConnection connection, const std::vector<IEC104::TCommandValue>& values);
+        template<class TConvertFn> void HandleCommand(IMasterConnection connection, CS101_ASDU asdu, TConvertFn fn);
+
+        //! Changes of information objects with timestamp are journaled while there are no active connections
+        //! and replayed to the first activated connection only. Other connections activated during replay
+        //! get new changes directly
+        std::unique_ptr<IEC104::TEventJournal> Journal;
+        std::vector<IMasterConnection> ActiveConnections;
+        IMasterConnection ReplayConnection;
+        std::mutex JournalMutex;
+        std::condition_variable JournalCv;
+        std::thread ReplayThread;
+        bool StopReplayThread;
+
+        void ReplayLoop();
+        void SetActive(IMasterConnection connection, bool active);
+
     public:
         TServerImpl(const IEC104::TServerConfig& config);
         ~TServerImpl();
 
         void Stop();
         void SendSpontaneous(const IEC104::TInformationObjects& objs);
+        void UpdateValues(const IEC104::TInformationObjects& objs);
+        void Reconfigure(const IEC104::TServerConfig& config, const IEC104::TInformationObjects& objs);
         void SetHandler(IEC104::IHandler* handler);
 
         bool IsReadyToAcceptConnections() const;
         bool HandleAsdu(IMasterConnection connection, CS101_ASDU asdu);
         void HandleConnectionEvent(IMasterConnection connection, CS104_PeerConnectionEvent event);
         void HandleInterrogationRequest(IMasterConnection connection, CS101_ASDU asdu, int qoi);
+        void HandleCounterInterrogationRequest(IMasterConnection connection, CS101_ASDU asdu, uint8_t qcc);
     };
 
     extern "C" {
@@ -65,168 +205,603 @@ namespace
         ((TServerImpl*)parameter)->HandleInterrogationRequest(connection, asdu, qoi);
         return true;
     }
+
+    bool CounterInterrogationHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu, uint8_t qcc)
+    {
+        ((TServerImpl*)parameter)->HandleCounterInterrogationRequest(connection, asdu, qcc);
+        return true;
+    }
     }
 
-    CS101_ASDU Append(InformationObject io,
-                      CS101_ASDU asdu,
-                      CS101_AppLayerParameters appLayerParameters,
-                      int commonAddress,
-                      CS101_CauseOfTransmission cot,
-                      std::function<void(CS101_ASDU)> sendFn)
+    std::string GetPeerAddress(IMasterConnection connection)
     {
-        if (!CS101_ASDU_addInformationObject(asdu, io)) {
-            sendFn(asdu);
-            CS101_ASDU_destroy(asdu);
-            asdu = CS101_ASDU_create(appLayerParameters, false, cot, 0, commonAddress, false, false);
-            if (!CS101_ASDU_addInformationObject(asdu, io)) {
-                LOG(Warn) << "Can't add information object with address " << InformationObject_getObjectAddress(io)
-                          << " to ASDU";
+        char addrBuf[24] = {0};
+        IMasterConnection_getPeerAddress(connection, addrBuf, sizeof(addrBuf) - 1);
+        return addrBuf;
+    }
+
+    TServerImpl::TServerImpl(const IEC104::TServerConfig& config)
+        : Handler(nullptr),
+          QueueSize(config.QueueSize),
+          Stations(std::make_shared<const IEC104::TStations>(config.CommonAddress, config.CommonAddresses)),
+          Cyclic(std::make_unique<IEC104::TCyclicTransmission>(config.CyclePeriods, std::chrono::steady_clock::now())),
+          StopCyclicThread(false),
+          CoalesceWindow(config.CoalesceWindow),
+          CoalesceMaxObjects(config.CoalesceMaxObjects),
+          PendingObjects(config.KeepEventsHistory),
+          StopFlushThread(false),
+          MaxPendingCommands(config.MaxPendingCommands),
+          SendActTerm(config.SendActTerm),
+          Selections(config.SelectTimeout, config.SelectTimeouts),
+          NextConnectionId(0),
+          StopCommandWorkers(false),
+          ReplayConnection(nullptr),
+          StopReplayThread(false)
+    {
+        if (!config.JournalFile.empty()) {
+            Journal = std::make_unique<IEC104::TEventJournal>(config.JournalFile,
+                                                              config.JournalSize,
+                                                              config.JournalOverflowPolicy);
+            if (config.RedundancyGroups.size() > 1) {
+                LOG(Warn) << "Events journal is replayed only to the first activated connection, "
+                             "other redundancy groups don't get journaled events";
+            }
+        }
+
+        Slave = CS104_Slave_create(config.QueueSize, config.QueueSize);
+
+        CS104_Slave_setLocalAddress(Slave, config.BindIp.empty() ? "0.0.0.0" : config.BindIp.c_str());
+        CS104_Slave_setLocalPort(Slave, config.BindPort);
+        CS104_Slave_setMaxOpenConnections(Slave, config.MaxConnections);
+
+        AppLayerParameters = CS104_Slave_getAppLayerParameters(Slave);
+        Images = MakeImages(config, *Stations, IEC104::TInformationObjects());
+        for (auto commonAddress: Stations->GetCommonAddresses()) {
+            Counters.emplace(commonAddress, IEC104::TCounters(config.InterrogationGroups));
+        }
+
+        CS104_Slave_setConnectionRequestHandler(Slave, RequestConnectionHandler, this);
+        CS104_Slave_setConnectionEventHandler(Slave, ConnectionEventHandler, this);
+        CS104_Slave_setASDUHandler(Slave, AsduHandler, this);
+        CS104_Slave_setClockSyncHandler(Slave, ClockSyncHandler, NULL);
+        CS104_Slave_setInterrogationHandler(Slave, InterrogationHandler, this);
+        CS104_Slave_setCounterInterrogationHandler(Slave, CounterInterrogationHandler, this);
+
+        // Set server mode to allow multiple clients using the application layer
+        if (config.RedundancyGroups.empty()) {
+            CS104_Slave_setServerMode(Slave, CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP);
+        } else {
+            CS104_Slave_setServerMode(Slave, CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS);
+            for (const auto& groupConfig: config.RedundancyGroups) {
+                // The slave owns the group
+                auto group = CS104_RedundancyGroup_create(groupConfig.Name.c_str());
+                for (const auto& client: groupConfig.AllowedClients) {
+                    CS104_RedundancyGroup_addAllowedClient(group, client.c_str());
+                }
+                CS104_Slave_addRedundancyGroup(Slave, group);
+                RedundancyGroups.push_back(group);
             }
         }
-        InformationObject_destroy(io);
-        return asdu;
+
+        CS104_Slave_start(Slave);
+
+        if (CS104_Slave_isRunning(Slave) == false) {
+            CS104_Slave_destroy(Slave);
+            throw std::runtime_error("starting IEC 60870-5-104 server failed");
+        }
+
+        if (CoalesceWindow.count()) {
+            FlushThread = std::thread([this]() { FlushLoop(); });
+        }
+        if (Journal) {
+            ReplayThread = std::thread([this]() { ReplayLoop(); });
+        }
+        StartCyclicLoop();
     }
 
-    InformationObject CreateInformationObject(const IEC104::TSinglePointInformationObject& obj)
+    TServerImpl::~TServerImpl()
     {
-        return (InformationObject)SinglePointInformation_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD);
+        TServerImpl::Stop();
+        CS104_Slave_destroy(Slave);
     }
 
-    InformationObject CreateInformationObject(const IEC104::TSinglePointInformationObjectWithTimestamp& obj)
+    void TServerImpl::Stop()
     {
-        sCP56Time2a timestamp;
-        CP56Time2a_createFromMsTimestamp(&timestamp,
-                                         duration_cast<milliseconds>(obj.Timestamp.time_since_epoch()).count());
-        return (InformationObject)
-            SinglePointWithCP56Time2a_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD, &timestamp);
+        {
+            std::unique_lock<std::mutex> lk(PendingObjectsMutex);
+            StopFlushThread = true;
+        }
+        PendingObjectsCv.notify_all();
+        if (FlushThread.joinable()) {
+            FlushThread.join();
+        }
+        std::vector<std::shared_ptr<TCommandWorker>> workers;
+        bool commandWorkersStopped;
+        {
+            std::unique_lock<std::mutex> lk(CommandsMutex);
+            commandWorkersStopped = StopCommandWorkers;
+            StopCommandWorkers = true;
+            for (auto& worker: Workers) {
+                worker.second->Stop = true;
+                worker.second->Cv.notify_all();
+                workers.push_back(worker.second);
+            }
+            Workers.clear();
+        }
+        for (auto& worker: workers) {
+            worker->Thread.join();
+        }
+        if (!commandWorkersStopped && Statistics.CommandLatency.GetCount()) {
+            LOG(Info) << "Commands latency " << Statistics.CommandLatency;
+        }
+        {
+            std::unique_lock<std::mutex> lk(JournalMutex);
+            StopReplayThread = true;
+        }
+        JournalCv.notify_all();
+        if (ReplayThread.joinable()) {
+            ReplayThread.join();
+        }
+        {
+            std::unique_lock<std::mutex> lk(CyclicMutex);
+            StopCyclicThread = true;
+        }
+        CyclicCv.notify_all();
+        if (CyclicThread.joinable()) {
+            CyclicThread.join();
+        }
+        if (CS104_Slave_isRunning(Slave) == true) {
+            CS104_Slave_stop(Slave);
+        }
     }
 
-    InformationObject CreateInformationObject(const IEC104::TMeasuredValueScaledInformationObject& obj)
+    void TServerImpl::FlushLoop()
     {
-        return (InformationObject)MeasuredValueScaled_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD);
+        std::unique_lock<std::mutex> lk(PendingObjectsMutex);
+        while (!StopFlushThread) {
+            PendingObjectsCv.wait(lk, [this]() { return StopFlushThread || !PendingObjects.IsEmpty(); });
+            if (PendingObjectsCv.wait_for(lk, CoalesceWindow, [this]() { return StopFlushThread; })) {
+                break;
+            }
+            if (!PendingObjects.IsEmpty()) {
+                EnqueueSpontaneous(PendingObjects.Take());
+            }
+        }
     }
 
-    InformationObject CreateInformationObject(const IEC104::TMeasuredValueScaledInformationObjectWithTimestamp& obj)
+    void TServerImpl::Enqueue(CS101_ASDU asdu)
     {
-        sCP56Time2a timestamp;
-        CP56Time2a_createFromMsTimestamp(&timestamp,
-                                         duration_cast<milliseconds>(obj.Timestamp.time_since_epoch()).count());
-        return (InformationObject)
-            MeasuredValueScaledWithCP56Time2a_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD, &timestamp);
+        // Full queue drops its oldest ASDU to take the new one
+        for (auto group: RedundancyGroups) {
+            if (CS104_Slave_getNumberOfQueueEntries(Slave, group) >= static_cast<int>(QueueSize)) {
+                Statistics.QueueDrops.Add();
+            }
+        }
+        CS104_Slave_enqueueASDU(Slave, asdu);
     }
 
-    InformationObject CreateInformationObject(const IEC104::TMeasuredValueShortInformationObject& obj)
+    void TServerImpl::EnqueueSpontaneous(const IEC104::TInformationObjects& objs)
     {
-        return (InformationObject)MeasuredValueShort_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD);
+        auto send = [&](CS101_ASDU asdu) {
+            Enqueue(asdu);
+            Statistics.SpontaneousAsdus.Add();
+            Statistics.SpontaneousObjects.Add(CS101_ASDU_getNumberOfElements(asdu));
+        };
+
+        auto stations = std::atomic_load(&Stations);
+        std::unique_lock<std::mutex> lk(JournalMutex);
+        if (!Journal || (!ActiveConnections.empty() && Journal->IsEmpty())) {
+            stations->Send(AppLayerParameters, CS101_COT_SPONTANEOUS, objs, send);
+            return;
+        }
+
+        // Keep order of events: while the journal is not empty, new events are appended to it
+        auto dropped = Journal->Append(objs);
+        if (dropped) {
+            Statistics.JournalDrops.Add(dropped);
+        }
+        JournalCv.notify_all();
+
+        // Events of the journal go only to the replay connection, other active connections get them now
+        if (ActiveConnections.size() > 1) {
+            IEC104::TInformationObjects objsWithTimestamp;
+            objsWithTimestamp.SinglePointWithTimestamp = objs.SinglePointWithTimestamp;
+            objsWithTimestamp.MeasuredValueShortWithTimestamp = objs.MeasuredValueShortWithTimestamp;
+            objsWithTimestamp.MeasuredValueScaledWithTimestamp = objs.MeasuredValueScaledWithTimestamp;
+            for (auto connection: ActiveConnections) {
+                if (connection == ReplayConnection) {
+                    continue;
+                }
+                stations->Send(AppLayerParameters, CS101_COT_SPONTANEOUS, objsWithTimestamp, [&](CS101_ASDU asdu) {
+                    if (!IMasterConnection_sendASDU(connection, asdu)) {
+                        Statistics.QueueDrops.Add();
+                    }
+                });
+            }
+        }
+
+        IEC104::TInformationObjects objsWithoutTimestamp;
+        objsWithoutTimestamp.SinglePoint = objs.SinglePoint;
+        objsWithoutTimestamp.MeasuredValueShort = objs.MeasuredValueShort;
+        objsWithoutTimestamp.MeasuredValueScaled = objs.MeasuredValueScaled;
+        objsWithoutTimestamp.DoublePoint = objs.DoublePoint;
+        objsWithoutTimestamp.MeasuredValueNormalized = objs.MeasuredValueNormalized;
+        objsWithoutTimestamp.BitString = objs.BitString;
+        objsWithoutTimestamp.StepPosition = objs.StepPosition;
+        stations->Send(AppLayerParameters, CS101_COT_SPONTANEOUS, objsWithoutTimestamp, send);
     }
 
-    InformationObject CreateInformationObject(const IEC104::TMeasuredValueShortInformationObjectWithTimestamp& obj)
+    void TServerImpl::ReplayLoop()
     {
-        sCP56Time2a timestamp;
-        CP56Time2a_createFromMsTimestamp(&timestamp,
-                                         duration_cast<milliseconds>(obj.Timestamp.time_since_epoch()).count());
-        return (InformationObject)
-            MeasuredValueShortWithCP56Time2a_create(NULL, obj.Address, obj.Value, IEC60870_QUALITY_GOOD, &timestamp);
+        std::unique_lock<std::mutex> lk(JournalMutex);
+        while (true) {
+            JournalCv.wait(lk, [this]() { return StopReplayThread || (ReplayConnection && !Journal->IsEmpty()); });
+            if (StopReplayThread) {
+                break;
+            }
+            IEC104::TInformationObjects objs;
+            auto count = Journal->Peek(REPLAY_CHUNK_SIZE, objs);
+            bool sent = true;
+            // Journal doesn't keep common addresses, stations of events are found by current configuration
+            std::atomic_load(&Stations)->Send(AppLayerParameters, CS101_COT_SPONTANEOUS, objs, [&](CS101_ASDU asdu) {
+                sent = sent && IMasterConnection_sendASDU(ReplayConnection, asdu);
+            });
+            if (sent) {
+                Journal->Pop(count);
+                Statistics.ReplayedEvents.Add(count);
+                if (Journal->IsEmpty()) {
+                    LOG(Info) << "Journaled events are replayed";
+                }
+            } else {
+                JournalCv.wait_for(lk, REPLAY_RETRY_INTERVAL, [this]() { return StopReplayThread; });
+            }
+        }
     }
 
-    void Send(CS101_AppLayerParameters appLayerParameters,
-              int commonAddress,
-              CS101_CauseOfTransmission cot,
-              const IEC104::TInformationObjects& objs,
-              std::function<void(CS101_ASDU)> sendFn)
+    void TServerImpl::StartCyclicLoop()
     {
-        CS101_ASDU asdu = CS101_ASDU_create(appLayerParameters, false, cot, 0, commonAddress, false, false);
-
-        for (const auto& val: objs.SinglePoint) {
-            asdu = Append(CreateInformationObject(val), asdu, appLayerParameters, commonAddress, cot, sendFn);
+        std::unique_lock<std::mutex> lk(CyclicMutex);
+        if (Cyclic->Size() && !CyclicThread.joinable() && !StopCyclicThread) {
+            CyclicThread = std::thread([this]() { CyclicLoop(); });
         }
-        for (const auto& val: objs.MeasuredValueShort) {
-            asdu = Append(CreateInformationObject(val), asdu, appLayerParameters, commonAddress, cot, sendFn);
+    }
+
+    void TServerImpl::CyclicLoop()
+    {
+        std::unique_lock<std::mutex> lk(CyclicMutex);
+        while (!CyclicCv.wait_for(lk, IEC104::TCyclicTransmission::TICK, [this]() { return StopCyclicThread; })) {
+            bool hasActiveConnections;
+            {
+                std::unique_lock<std::mutex> journalLk(JournalMutex);
+                hasActiveConnections = !ActiveConnections.empty();
+            }
+            // Timers are advanced anyway, so disconnected masters don't get a burst of outdated values later
+            auto stations = std::atomic_load(&Stations);
+            Cyclic->Send(AppLayerParameters, *stations, std::chrono::steady_clock::now(), [&](CS101_ASDU asdu) {
+                if (hasActiveConnections) {
+                    Enqueue(asdu);
+                }
+            });
         }
-        for (const auto& val: objs.MeasuredValueScaled) {
-            asdu = Append(CreateInformationObject(val), asdu, appLayerParameters, commonAddress, cot, sendFn);
+    }
+
+    void TServerImpl::SetActive(IMasterConnection connection, bool active)
+    {
+        std::unique_lock<std::mutex> lk(JournalMutex);
+        ActiveConnections.erase(std::remove(ActiveConnections.begin(), ActiveConnections.end(), connection),
+                                ActiveConnections.end());
+        if (active) {
+            ActiveConnections.push_back(connection);
         }
-        for (const auto& val: objs.SinglePointWithTimestamp) {
-            asdu = Append(CreateInformationObject(val), asdu, appLayerParameters, commonAddress, cot, sendFn);
+        if (!ReplayConnection || ReplayConnection == connection) {
+            ReplayConnection = ActiveConnections.empty() ? nullptr : ActiveConnections.front();
         }
-        for (const auto& val: objs.MeasuredValueShortWithTimestamp) {
-            asdu = Append(CreateInformationObject(val), asdu, appLayerParameters, commonAddress, cot, sendFn);
+        if (Journal && ReplayConnection && !Journal->IsEmpty()) {
+            LOG(Info) << "Replay " << Journal->Size() << " journaled events";
+            JournalCv.notify_all();
         }
-        for (const auto& val: objs.MeasuredValueScaledWithTimestamp) {
-            asdu = Append(CreateInformationObject(val), asdu, appLayerParameters, commonAddress, cot, sendFn);
+    }
+
+    void TServerImpl::SendSpontaneous(const IEC104::TInformationObjects& objs)
+    {
+        if (CS104_Slave_isRunning(Slave) == false) {
+            throw std::runtime_error("IEC 60870-5-104 is not running");
         }
 
-        if (CS101_ASDU_getPayloadSize(asdu)) {
-            sendFn(asdu);
+        UpdateValues(objs);
+
+        std::unique_lock<std::mutex> lk(PendingObjectsMutex);
+        if (!CoalesceWindow.count()) {
+            EnqueueSpontaneous(objs);
+            return;
+        }
+        if (PendingObjects.Add(objs) >= CoalesceMaxObjects) {
+            EnqueueSpontaneous(PendingObjects.Take());
+            return;
         }
-        CS101_ASDU_destroy(asdu);
+        PendingObjectsCv.notify_all();
     }
 
-    void HandleCommand(CS101_ASDU asdu,
-                       IMasterConnection connection,
-                       IEC104::IHandler* handler,
-                       std::function<std::string(InformationObject io)> fn)
+    void TServerImpl::UpdateValues(const IEC104::TInformationObjects& objs)
     {
-        if (CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION) {
-            InformationObject io = CS101_ASDU_getElement(asdu, 0);
-            CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION_CON);
-            if (!handler->SetParameter(InformationObject_getObjectAddress(io), fn(io))) {
-                CS101_ASDU_setNegative(asdu, true);
-            }
-            InformationObject_destroy(io);
-        } else {
-            CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_COT);
+        auto stations = std::atomic_load(&Stations);
+        {
+            std::unique_lock<std::mutex> lk(ImageMutex);
+            stations->Split(objs, [&](uint16_t commonAddress, const IEC104::TInformationObjects& stationObjs) {
+                auto it = Images.find(commonAddress);
+                if (it != Images.end()) {
+                    it->second->Update(stationObjs);
+                }
+            });
+        }
+        if (!objs.IntegratedTotals.empty()) {
+            std::unique_lock<std::mutex> lk(CountersMutex);
+            stations->Split(objs, [&](uint16_t commonAddress, const IEC104::TInformationObjects& stationObjs) {
+                auto it = Counters.find(commonAddress);
+                if (it != Counters.end() && !stationObjs.IntegratedTotals.empty()) {
+                    it->second.Update(stationObjs.IntegratedTotals);
+                }
+            });
+        }
+        if (!objs.MeasuredValueShort.empty() || !objs.MeasuredValueScaled.empty() ||
+            !objs.MeasuredValueNormalized.empty())
+        {
+            std::unique_lock<std::mutex> lk(CyclicMutex);
+            Cyclic->Update(objs);
         }
-        IMasterConnection_sendASDU(connection, asdu);
     }
 
-    TServerImpl::TServerImpl(const IEC104::TServerConfig& config): CommonAddress(config.CommonAddress), Handler(nullptr)
+    TServerImpl::TImages TServerImpl::MakeImages(const IEC104::TServerConfig& config,
+                                                 const IEC104::TStations& stations,
+                                                 const IEC104::TInformationObjects& objs) const
     {
-        Slave = CS104_Slave_create(100, 100);
+        TImages images;
+        for (auto commonAddress: stations.GetCommonAddresses()) {
+            images[commonAddress] = std::make_unique<IEC104::TInterrogationImage>(AppLayerParameters,
+                                                                                  config.InterrogationGroups,
+                                                                                  config.SequenceEncoding);
+        }
+        stations.Split(objs, [&](uint16_t commonAddress, const IEC104::TInformationObjects& stationObjs) {
+            images[commonAddress]->Update(stationObjs);
+        });
+        return images;
+    }
 
-        CS104_Slave_setLocalAddress(Slave, config.BindIp.empty() ? "0.0.0.0" : config.BindIp.c_str());
+    void TServerImpl::Reconfigure(const IEC104::TServerConfig& config, const IEC104::TInformationObjects& objs)
+    {
+        auto stations = std::make_shared<const IEC104::TStations>(config.CommonAddress, config.CommonAddresses);
 
-        AppLayerParameters = CS104_Slave_getAppLayerParameters(Slave);
+        // New images are built aside, so interrogations are not blocked meanwhile
+        auto images = MakeImages(config, *stations, objs);
+        {
+            std::unique_lock<std::mutex> lk(ImageMutex);
+            Images.swap(images);
+        }
+        std::atomic_store(&Stations, stations);
 
-        CS104_Slave_setConnectionRequestHandler(Slave, RequestConnectionHandler, this);
-        CS104_Slave_setConnectionEventHandler(Slave, ConnectionEventHandler, this);
-        CS104_Slave_setASDUHandler(Slave, AsduHandler, this);
-        CS104_Slave_setClockSyncHandler(Slave, ClockSyncHandler, NULL);
-        CS104_Slave_setInterrogationHandler(Slave, InterrogationHandler, this);
+        std::map<uint16_t, std::vector<IEC104::TIntegratedTotalsInformationObject>> totals;
+        stations->Split(objs, [&](uint16_t commonAddress, const IEC104::TInformationObjects& stationObjs) {
+            totals[commonAddress] = stationObjs.IntegratedTotals;
+        });
+        {
+            std::unique_lock<std::mutex> lk(CountersMutex);
+            // Counters of kept stations keep their frozen readings, counters moved to another station are reset
+            std::map<uint16_t, IEC104::TCounters> counters;
+            for (auto commonAddress: stations->GetCommonAddresses()) {
+                auto it = Counters.find(commonAddress);
+                auto& stationCounters = (it != Counters.end())
+                                            ? counters.emplace(commonAddress, std::move(it->second)).first->second
+                                            : counters.emplace(commonAddress, config.InterrogationGroups).first->second;
+                stationCounters.Reconfigure(config.InterrogationGroups, totals[commonAddress]);
+            }
+            Counters.swap(counters);
+        }
+        {
+            std::unique_lock<std::mutex> lk(CommandsMutex);
+            Selections.SetTimeouts(config.SelectTimeout, config.SelectTimeouts);
+        }
+        auto cyclic =
+            std::make_unique<IEC104::TCyclicTransmission>(config.CyclePeriods, std::chrono::steady_clock::now());
+        cyclic->Update(objs);
+        {
+            std::unique_lock<std::mutex> lk(CyclicMutex);
+            Cyclic.swap(cyclic);
+        }
+        StartCyclicLoop();
+    }
 
-        // Set server mode to allow multiple clients using the application layer
-        CS104_Slave_setServerMode(Slave, CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP);
+    bool TServerImpl::EnqueueCommand(IMasterConnection connection,
+                                     CS101_ASDU asdu,
+                                     std::vector<IEC104::TCommandValue>&& values)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lk(CommandsMutex);
+        auto it = ConnectionIds.find(connection);
+        if (it == ConnectionIds.end() || StopCommandWorkers) {
+            return false;
+        }
+        auto& worker = Workers[it->second];
+        if (!worker) {
+            worker = std::make_shared<TCommandWorker>();
+            worker->Thread = std::thread([this, w = worker.get()]() { CommandLoop(*w); });
+        }
+        if (worker->Pending >= MaxPendingCommands) {
+            LOG(Warn) << GetPeerAddress(connection) << " too many pending commands, IOA: " << values.front().Address
+                      << " is rejected";
+            return false;
+        }
+        for (const auto& value: values) {
+            if (!Selections.IsAvailable(it->second, value.Address, now)) {
+                LOG(Warn) << GetPeerAddress(connection) << " command IOA: " << value.Address
+                          << " is rejected, it is selected by another connection";
+                return false;
+            }
+        }
+        // Execution completes select-before-operate procedure
+        for (const auto& value: values) {
+            Selections.Release(it->second, value.Address);
+        }
+        ++worker->Pending;
+        TCommand command{connection,
+                         std::make_unique<sCS101_StaticASDU>(),
+                         nullptr,
+                         std::move(values),
+                         now};
+        command.Asdu = CS101_ASDU_clone(asdu, command.AsduBuffer.get());
+        worker->Commands.push_back(std::move(command));
+        worker->Cv.notify_all();
+        return true;
+    }
 
-        CS104_Slave_start(Slave);
+    bool TServerImpl::SelectCommand(IMasterConnection connection, const std::vector<IEC104::TCommandValue>& values)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lk(CommandsMutex);
+        auto it = ConnectionIds.find(connection);
+        if (it == ConnectionIds.end()) {
+            return false;
+        }
+        for (const auto& value: values) {
+            if (!Selections.IsAvailable(it->second, value.Address, now)) {
+                LOG(Warn) << GetPeerAddress(connection) << " can't select IOA: " << value.Address
+                          << ", it is selected by another connection";
+                return false;
+            }
+        }
+        for (const auto& value: values) {
+            Selections.Select(it->second, value.Address, now);
+        }
+        return true;
+    }
 
-        if (CS104_Slave_isRunning(Slave) == false) {
-            CS104_Slave_destroy(Slave);
-            throw std::runtime_error("starting IEC 60870-5-104 server failed");
+    void TServerImpl::DeselectCommand(IMasterConnection connection, const std::vector<IEC104::TCommandValue>& values)
+    {
+        std::unique_lock<std::mutex> lk(CommandsMutex);
+        auto it = ConnectionIds.find(connection);
+        if (it != ConnectionIds.end()) {
+            for (const auto& value: values) {
+                Selections.Release(it->second, value.Address);
+            }
         }
     }
 
-    TServerImpl::~TServerImpl()
+    void TServerImpl::CommandLoop(TCommandWorker& worker)
     {
-        TServerImpl::Stop();
-        CS104_Slave_destroy(Slave);
+        std::unique_lock<std::mutex> lk(CommandsMutex);
+        while (true) {
+            worker.Cv.wait(lk, [&worker]() { return worker.Stop || !worker.Commands.empty(); });
+            if (worker.Stop) {
+                break;
+            }
+            auto command = std::move(worker.Commands.front());
+            worker.Commands.pop_front();
+            lk.unlock();
+            ExecuteCommand(worker, command);
+            lk.lock();
+        }
     }
 
-    void TServerImpl::Stop()
+    void TServerImpl::ExecuteCommand(TCommandWorker& worker, TCommand& command)
     {
-        if (CS104_Slave_isRunning(Slave) == true) {
-            CS104_Slave_stop(Slave);
+        bool res = Handler->SetParameters(command.Values);
+        auto latency = std::chrono::steady_clock::now() - command.ReceiveTime;
+        Statistics.CommandLatency.Add(latency);
+        (res ? Statistics.CommandsSucceeded : Statistics.CommandsFailed).Add();
+        LOG(Debug) << "Command IOA: " << command.Values.front().Address << " (" << command.Values.size()
+                   << " objects) is executed in "
+                   << std::chrono::duration_cast<std::chrono::microseconds>(latency).count() << "us";
+
+        // Connection can't be closed while confirmation is sent, as closing waits for CommandsMutex
+        std::unique_lock<std::mutex> lk(CommandsMutex);
+        if (worker.Stop) {
+            LOG(Debug) << "Connection is closed, confirmation of command IOA: " << command.Values.front().Address
+                       << " is dropped";
+            return;
+        }
+        --worker.Pending;
+        CS101_ASDU_setCOT(command.Asdu, CS101_COT_ACTIVATION_CON);
+        CS101_ASDU_setNegative(command.Asdu, !res);
+        IMasterConnection_sendASDU(command.Connection, command.Asdu);
+        if (res && SendActTerm) {
+            CS101_ASDU_setCOT(command.Asdu, CS101_COT_ACTIVATION_TERMINATION);
+            IMasterConnection_sendASDU(command.Connection, command.Asdu);
         }
     }
 
-    void TServerImpl::SendSpontaneous(const IEC104::TInformationObjects& objs)
+    template<class TConvertFn>
+    void TServerImpl::HandleCommand(IMasterConnection connection, CS101_ASDU asdu, TConvertFn fn)
     {
-        if (CS104_Slave_isRunning(Slave) == false) {
-            throw std::runtime_error("IEC 60870-5-104 is not running");
+        auto cot = CS101_ASDU_getCOT(asdu);
+        if (cot != CS101_COT_ACTIVATION && cot != CS101_COT_DEACTIVATION) {
+            CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_COT);
+            IMasterConnection_sendASDU(connection, asdu);
+            return;
         }
+        auto confirm = [&](bool positive) {
+            CS101_ASDU_setCOT(asdu,
+                              (cot == CS101_COT_ACTIVATION) ? CS101_COT_ACTIVATION_CON : CS101_COT_DEACTIVATION_CON);
+            CS101_ASDU_setNegative(asdu, !positive);
+            IMasterConnection_sendASDU(connection, asdu);
+        };
+        auto reject = [&](CS101_CauseOfTransmission reason) {
+            CS101_ASDU_setCOT(asdu, reason);
+            CS101_ASDU_setNegative(asdu, true);
+            IMasterConnection_sendASDU(connection, asdu);
+        };
 
-        Send(AppLayerParameters, CommonAddress, CS101_COT_SPONTANEOUS, objs, [&](CS101_ASDU asdu) {
-            CS104_Slave_enqueueASDU(Slave, asdu);
-        });
+        auto stations = std::atomic_load(&Stations);
+        auto commonAddress = CS101_ASDU_getCA(asdu);
+        if (!stations->HasStation(commonAddress)) {
+            LOG(Warn) << GetPeerAddress(connection) << " command with unknown common address " << commonAddress;
+            reject(CS101_COT_UNKNOWN_CA);
+            return;
+        }
+
+        // All information objects of the ASDU are one command, so they must have the same S/E bit
+        std::vector<IEC104::TCommandValue> values(CS101_ASDU_getNumberOfElements(asdu));
+        bool isValid = !values.empty();
+        bool select = false;
+        for (size_t i = 0; i < values.size() && isValid; ++i) {
+            InformationObject io = CS101_ASDU_getElement(asdu, i);
+            if (io == nullptr) {
+                isValid = false;
+                break;
+            }
+            values[i].Address = InformationObject_getObjectAddress(io);
+            if (stations->GetCommonAddress(values[i].Address) != commonAddress) {
+                InformationObject_destroy(io);
+                LOG(Warn) << GetPeerAddress(connection) << " command IOA: " << values[i].Address
+                          << " doesn't belong to station " << commonAddress;
+                reject(CS101_COT_UNKNOWN_IOA);
+                return;
+            }
+            bool isSelect = false;
+            isValid = fn(io, values[i], isSelect) && (i == 0 || isSelect == select);
+            select = isSelect;
+            InformationObject_destroy(io);
+        }
+        if (!isValid) {
+            LOG(Warn) << GetPeerAddress(connection) << " " << TypeID_toString(CS101_ASDU_getTypeID(asdu))
+                      << " command has not permitted state or mixed select and execute";
+            confirm(false);
+            return;
+        }
+        if (cot == CS101_COT_DEACTIVATION) {
+            // Only selection can be cancelled, executed command can't be undone
+            if (select) {
+                DeselectCommand(connection, values);
+            }
+            confirm(select);
+            return;
+        }
+        if (select) {
+            confirm(SelectCommand(connection, values));
+            return;
+        }
+        if (!EnqueueCommand(connection, asdu, std::move(values))) {
+            Statistics.CommandsRejected.Add();
+            confirm(false);
+        }
     }
 
     bool TServerImpl::IsReadyToAcceptConnections() const
@@ -239,6 +814,7 @@ namespace
         if (Handler != nullptr) {
             throw std::runtime_error("IIEC104Handler can be set only once");
         }
+        UpdateValues(handler->GetInformationObjectsValues());
         Handler = handler;
     }
 
@@ -256,20 +832,74 @@ namespace
         switch (asduType) {
             case C_SC_NA_1: // Single command
             case C_SC_TA_1: // Single command with timestamp
-                HandleCommand(asdu, connection, Handler, [](InformationObject io) {
-                    return (SingleCommand_getState((SingleCommand)io) ? "1" : "0");
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool& select) {
+                    SetIntValue(value, SingleCommand_getState((SingleCommand)io) ? 1 : 0);
+                    select = SingleCommand_isSelect((SingleCommand)io);
+                    return true;
+                });
+                return true;
+            case C_DC_NA_1: // Double command
+            case C_DC_TA_1: // Double command with timestamp
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool& select) {
+                    select = DoubleCommand_isSelect((DoubleCommand)io);
+                    switch (DoubleCommand_getState((DoubleCommand)io)) {
+                        case IEC60870_DOUBLE_POINT_OFF:
+                            SetIntValue(value, 0);
+                            return true;
+                        case IEC60870_DOUBLE_POINT_ON:
+                            SetIntValue(value, 1);
+                            return true;
+                        default:
+                            return false;
+                    }
+                });
+                return true;
+            case C_RC_NA_1: // Regulating step command
+            case C_RC_TA_1: // Regulating step command with timestamp
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool& select) {
+                    select = StepCommand_isSelect((StepCommand)io);
+                    switch (StepCommand_getState((StepCommand)io)) {
+                        case IEC60870_STEP_LOWER:
+                            value.Step = -1;
+                            return true;
+                        case IEC60870_STEP_HIGHER:
+                            value.Step = 1;
+                            return true;
+                        default:
+                            return false;
+                    }
+                });
+                return true;
+            case C_SE_NA_1: // Measured value normalized command
+            case C_SE_TA_1: // Measured value normalized command with timestamp
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool& select) {
+                    SetFloatValue(value, SetpointCommandNormalized_getValue((SetpointCommandNormalized)io));
+                    select = SetpointCommandNormalized_isSelect((SetpointCommandNormalized)io);
+                    return true;
                 });
                 return true;
             case C_SE_NB_1: // Measured value scaled command
             case C_SE_TB_1: // Measured value scaled command with timestamp
-                HandleCommand(asdu, connection, Handler, [](InformationObject io) {
-                    return std::to_string(MeasuredValueScaled_getValue((MeasuredValueScaled)io));
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool& select) {
+                    SetIntValue(value, SetpointCommandScaled_getValue((SetpointCommandScaled)io));
+                    select = SetpointCommandScaled_isSelect((SetpointCommandScaled)io);
+                    return true;
                 });
                 return true;
             case C_SE_NC_1: // Measured value short command
             case C_SE_TC_1: // Measured value short command with timestamp
-                HandleCommand(asdu, connection, Handler, [](InformationObject io) {
-                    return std::to_string(MeasuredValueShort_getValue((MeasuredValueShort)io));
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool& select) {
+                    SetFloatValue(value, SetpointCommandShort_getValue((SetpointCommandShort)io));
+                    select = SetpointCommandShort_isSelect((SetpointCommandShort)io);
+                    return true;
+                });
+                return true;
+            case C_BO_NA_1: // Bitstring of 32 bit command
+            case C_BO_TA_1: // Bitstring of 32 bit command with timestamp
+                // The command has no qualifier, so it is always executed directly
+                HandleCommand(connection, asdu, [](InformationObject io, IEC104::TCommandValue& value, bool&) {
+                    SetIntValue(value, Bitstring32Command_getValue((Bitstring32Command)io));
+                    return true;
                 });
                 return true;
             default:
@@ -283,45 +913,174 @@ namespace
         char addrBuf[24] = {0};
         IMasterConnection_getPeerAddress(connection, addrBuf, sizeof(addrBuf) - 1);
         switch (event) {
-            case CS104_CON_EVENT_CONNECTION_OPENED:
+            case CS104_CON_EVENT_CONNECTION_OPENED: {
                 LOG(Info) << "Connection opened " << addrBuf;
+                Statistics.ConnectedMasters.Add(1);
+                std::unique_lock<std::mutex> lk(CommandsMutex);
+                ConnectionIds[connection] = NextConnectionId++;
                 break;
-            case CS104_CON_EVENT_CONNECTION_CLOSED:
+            }
+            case CS104_CON_EVENT_CONNECTION_CLOSED: {
                 LOG(Info) << "Connection closed " << addrBuf;
+                Statistics.ConnectedMasters.Add(-1);
+                SetActive(connection, false);
+                std::shared_ptr<TCommandWorker> worker;
+                {
+                    std::unique_lock<std::mutex> lk(CommandsMutex);
+                    auto it = ConnectionIds.find(connection);
+                    if (it != ConnectionIds.end()) {
+                        auto id = it->second;
+                        Selections.ReleaseAll(id);
+                        ConnectionIds.erase(it);
+                        auto workerIt = Workers.find(id);
+                        if (workerIt != Workers.end()) {
+                            worker = std::move(workerIt->second);
+                            Workers.erase(workerIt);
+                            worker->Stop = true;
+                            worker->Cv.notify_all();
+                            if (!worker->Commands.empty()) {
+                                LOG(Warn) << worker->Commands.size() << " pending commands from " << addrBuf
+                                          << " are dropped";
+                            }
+                        }
+                    }
+                }
+                // Executing command is waited for, so its confirmation is not sent to the closed connection
+                if (worker) {
+                    worker->Thread.join();
+                }
                 break;
+            }
             case CS104_CON_EVENT_DEACTIVATED:
                 LOG(Info) << "Connection deactivated " << addrBuf;
+                SetActive(connection, false);
                 break;
             case CS104_CON_EVENT_ACTIVATED: {
                 LOG(Info) << "Connection activated " << addrBuf;
-                Send(AppLayerParameters,
-                     CommonAddress,
-                     CS101_COT_SPONTANEOUS,
-                     Handler->GetInformationObjectsValues(),
-                     [&](CS101_ASDU asdu) { CS104_Slave_enqueueASDU(Slave, asdu); });
+                SetActive(connection, true);
+                // Only the activated connection gets current values, other connections are up to date
+                std::unique_lock<std::mutex> lk(ImageMutex);
+                for (const auto& image: Images) {
+                    image.second->Send(CS101_COT_SPONTANEOUS, image.first, [&](CS101_ASDU asdu) {
+                        if (!IMasterConnection_sendASDU(connection, asdu)) {
+                            Statistics.SnapshotDrops.Add();
+                        }
+                    });
+                }
                 break;
             }
         }
     }
 
-    void TServerImpl::HandleInterrogationRequest(IMasterConnection connection, CS101_ASDU incomimgAsdu, int qoi)
+    bool TServerImpl::GetInterrogatedStations(IMasterConnection connection,
+                                              CS101_ASDU asdu,
+                                              std::vector<uint16_t>& res)
     {
-        if (qoi == IEC60870_QOI_STATION) { /* only handle station interrogation */
-            IMasterConnection_sendACT_CON(connection, incomimgAsdu, false);
-
-            Send(AppLayerParameters,
-                 CommonAddress,
-                 CS101_COT_INTERROGATED_BY_STATION,
-                 Handler->GetInformationObjectsValues(),
-                 [&](CS101_ASDU asdu) { IMasterConnection_sendASDU(connection, asdu); });
+        auto stations = std::atomic_load(&Stations);
+        auto commonAddress = CS101_ASDU_getCA(asdu);
+        if (commonAddress == IEC104::BROADCAST_COMMON_ADDRESS) {
+            res = stations->GetCommonAddresses();
+            return true;
+        }
+        if (stations->HasStation(commonAddress)) {
+            res.assign(1, commonAddress);
+            return true;
+        }
+        LOG(Warn) << GetPeerAddress(connection) << " unknown common address " << commonAddress;
+        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_CA);
+        CS101_ASDU_setNegative(asdu, true);
+        IMasterConnection_sendASDU(connection, asdu);
+        return false;
+    }
 
-            IMasterConnection_sendACT_TERM(connection, incomimgAsdu);
-        } else {
+    void TServerImpl::HandleInterrogationRequest(IMasterConnection connection, CS101_ASDU incomimgAsdu, int qoi)
+    {
+        if (qoi != IEC60870_QOI_STATION && (qoi < IEC60870_QOI_GROUP_1 || qoi > IEC60870_QOI_GROUP_16)) {
             char addrBuf[24] = {0};
             IMasterConnection_getPeerAddress(connection, addrBuf, sizeof(addrBuf) - 1);
             LOG(Warn) << addrBuf << " unsupported interrogation qoi=" << qoi;
             IMasterConnection_sendACT_CON(connection, incomimgAsdu, true);
+            return;
+        }
+
+        std::vector<uint16_t> commonAddresses;
+        if (!GetInterrogatedStations(connection, incomimgAsdu, commonAddresses)) {
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto send = [&](CS101_ASDU asdu) { IMasterConnection_sendASDU(connection, asdu); };
+        for (auto commonAddress: commonAddresses) {
+            // Every station answers broadcast interrogation with its own common address
+            CS101_ASDU_setCA(incomimgAsdu, commonAddress);
+            IMasterConnection_sendACT_CON(connection, incomimgAsdu, false);
+            {
+                std::unique_lock<std::mutex> lk(ImageMutex);
+                auto it = Images.find(commonAddress);
+                if (it != Images.end() && qoi == IEC60870_QOI_STATION) {
+                    it->second->Send(CS101_COT_INTERROGATED_BY_STATION, commonAddress, send);
+                } else if (it != Images.end()) {
+                    // COT of group interrogation response (21-36) has the same value as QOI
+                    it->second->SendGroup(qoi - IEC60870_QOI_STATION,
+                                          static_cast<CS101_CauseOfTransmission>(qoi),
+                                          commonAddress,
+                                          send);
+                }
+            }
+            IMasterConnection_sendACT_TERM(connection, incomimgAsdu);
+        }
+        Statistics.Interrogations.Add();
+        Statistics.InterrogationDuration.Add(std::chrono::steady_clock::now() - start);
+    }
+
+    void TServerImpl::HandleCounterInterrogationRequest(IMasterConnection connection,
+                                                       CS101_ASDU incomimgAsdu,
+                                                       uint8_t qcc)
+    {
+        const uint8_t rqt = qcc & QCC_RQT_MASK;
+        const uint8_t frz = qcc & QCC_FRZ_MASK;
+        if (rqt == 0 || rqt > IEC60870_QCC_RQT_GENERAL) {
+            LOG(Warn) << GetPeerAddress(connection) << " unsupported counter interrogation qcc=" << int(qcc);
+            IMasterConnection_sendACT_CON(connection, incomimgAsdu, true);
+            return;
+        }
+
+        std::vector<uint16_t> commonAddresses;
+        if (!GetInterrogatedStations(connection, incomimgAsdu, commonAddresses)) {
+            return;
+        }
+
+        uint8_t group = IEC104::GetCounterGroup(rqt);
+        auto now = std::chrono::system_clock::now();
+        for (auto commonAddress: commonAddresses) {
+            CS101_ASDU_setCA(incomimgAsdu, commonAddress);
+            IMasterConnection_sendACT_CON(connection, incomimgAsdu, false);
+            {
+                std::unique_lock<std::mutex> lk(CountersMutex);
+                auto it = Counters.find(commonAddress);
+                if (it != Counters.end()) {
+                    auto& counters = it->second;
+                    switch (frz) {
+                        case IEC60870_QCC_FRZ_READ: {
+                            auto cot = IEC104::GetCounterInterrogationCot(rqt);
+                            counters.Send(AppLayerParameters, commonAddress, group, cot, [&](CS101_ASDU asdu) {
+                                IMasterConnection_sendASDU(connection, asdu);
+                            });
+                            break;
+                        }
+                        case IEC60870_QCC_FRZ_FREEZE_WITHOUT_RESET:
+                        case IEC60870_QCC_FRZ_FREEZE_WITH_RESET:
+                            counters.Freeze(group, frz == IEC60870_QCC_FRZ_FREEZE_WITH_RESET, now);
+                            break;
+                        case IEC60870_QCC_FRZ_COUNTER_RESET:
+                            counters.Reset(group);
+                            break;
+                    }
+                }
+            }
+            IMasterConnection_sendACT_TERM(connection, incomimgAsdu);
         }
+        Statistics.CounterInterrogations.Add();
     }
 }
 
@@ -1,13 +1,51 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "value_formatter.h"
+
 namespace IEC104
 {
+    //! What to do with a new event if events journal is full
+    enum class TJournalOverflowPolicy
+    {
+        DropOldest,
+        DropNewest
+    };
+
+    //! Maximum number of interrogation group. Groups 1-16 are interrogated with QOI 21-36
+    const uint8_t MAX_INTERROGATION_GROUP = 16;
+
+    //! Maps information object address to its interrogation group
+    typedef std::unordered_map<uint32_t, uint8_t> TInterrogationGroups;
+
+    //! Maps information object address to period of its cyclic transmission
+    typedef std::unordered_map<uint32_t, std::chrono::milliseconds> TCyclePeriods;
+
+    //! Maps information object address to timeout of its selection by select-before-operate command
+    typedef std::unordered_map<uint32_t, std::chrono::milliseconds> TSelectTimeouts;
+
+    //! Maps information object address to common address of its station
+    typedef std::unordered_map<uint32_t, uint16_t> TCommonAddresses;
+
+    //! Common address of interrogation or counter interrogation addressed to all stations
+    const uint16_t BROADCAST_COMMON_ADDRESS = 0xFFFF;
+
+    //! Redundancy group of masters. Masters of a group share one queue of spontaneous messages
+    struct TRedundancyGroup
+    {
+        std::string Name;
+
+        //! IP addresses of group masters. A group without addresses accepts masters not listed in other groups
+        std::vector<std::string> AllowedClients;
+    };
+
     //! IEC104 server configuration parameters
     struct TServerConfig
     {
@@ -17,16 +55,89 @@ namespace IEC104
         //! Port to listen
         uint16_t BindPort;
 
-        //! IEC common address
+        //! IEC common address of the station which information objects belong to by default
         uint32_t CommonAddress;
+
+        //! Information objects of other stations served by the server. Addresses of information objects are unique
+        //! across all stations, every station is interrogated separately by its own common address
+        TCommonAddresses CommonAddresses;
+
+        //! Spontaneous changes are gathered during this time and sent together. Zero disables coalescing
+        std::chrono::milliseconds CoalesceWindow = std::chrono::milliseconds::zero();
+
+        //! Gathered spontaneous changes are sent immediately if their number reaches the limit
+        size_t CoalesceMaxObjects = 1000;
+
+        //! Send every change of an information object with timestamp gathered during coalescing window
+        bool KeepEventsHistory = false;
+
+        //! Maximum number of queued and executing commands per connection. Extra commands get negative confirmation
+        size_t MaxPendingCommands = 16;
+
+        //! Send activation termination after positive activation confirmation of a command
+        bool SendActTerm = false;
+
+        //! Maximum number of ASDUs in a connection queue for spontaneous transmission
+        size_t QueueSize = 100;
+
+        //! Maximum number of simultaneously open connections
+        size_t MaxConnections = 5;
+
+        //! If empty, every connection has its own queue of spontaneous messages
+        std::vector<TRedundancyGroup> RedundancyGroups;
+
+        //! File of persistent journal for information objects with timestamp changed while there are no
+        //! active connections. If empty, the journal is disabled and such changes are lost
+        std::string JournalFile;
+
+        //! Maximum number of records in the journal
+        size_t JournalSize = 10000;
+
+        TJournalOverflowPolicy JournalOverflowPolicy = TJournalOverflowPolicy::DropOldest;
+
+        //! Interrogation groups of information objects. Objects without group are sent only on station interrogation.
+        //! Counters of interrogation groups 1-4 are also sent on interrogation of the same counter group
+        TInterrogationGroups InterrogationGroups;
+
+        //! Measured values without timestamp which are sent periodically (COT 1) besides spontaneous transmission
+        TCyclePeriods CyclePeriods;
+
+        //! Send consecutive addresses of the same type without timestamp as sequences of elements (SQ=1)
+        //! in interrogation responses. A master must support variable structure qualifier with SQ=1
+        bool SequenceEncoding = false;
+
+        //! Selection of an information object by select command (S/E = 1) expires if it is not executed in time
+        std::chrono::milliseconds SelectTimeout = std::chrono::milliseconds(10000);
+
+        //! Select timeouts of information objects which differ from SelectTimeout
+        TSelectTimeouts SelectTimeouts;
     };
 
+    //! Quality descriptor bits of information objects as they are defined in IEC 60870-5-101
+    const uint8_t QUALITY_GOOD = 0;
+    const uint8_t QUALITY_NON_TOPICAL = 0x40;
+    const uint8_t QUALITY_INVALID = 0x80;
+
+    //! Values of double point information object as they are defined in IEC 60870-5-101
+    const uint8_t DOUBLE_POINT_INTERMEDIATE = 0;
+    const uint8_t DOUBLE_POINT_OFF = 1;
+    const uint8_t DOUBLE_POINT_ON = 2;
+    const uint8_t DOUBLE_POINT_INDETERMINATE = 3;
+
+    //! Range of step position information object value
+    const int STEP_POSITION_MIN = -64;
+    const int STEP_POSITION_MAX = 63;
+
     template<class T> struct TInformationObject
     {
         uint32_t Address;
         T Value;
+        uint8_t Quality;
 
-        TInformationObject(uint32_t address, T value): Address(address), Value(value)
+        TInformationObject(uint32_t address, T value, uint8_t quality = QUALITY_GOOD)
+            : Address(address),
+              Value(value),
+              Quality(quality)
         {}
     };
 
@@ -37,8 +148,9 @@ namespace IEC104
 
         TInformationObjectWithTimestamp(uint32_t address,
                                         const std::chrono::system_clock::time_point& timestamp,
-                                        T value)
-            : TInformationObject<T>(address, value),
+                                        T value,
+                                        uint8_t quality = QUALITY_GOOD)
+            : TInformationObject<T>(address, value, quality),
               Timestamp(timestamp)
         {}
     };
@@ -47,19 +159,81 @@ namespace IEC104
     typedef TInformationObject<float> TMeasuredValueShortInformationObject;
     typedef TInformationObject<int> TMeasuredValueScaledInformationObject;
 
+    //! Value is one of DOUBLE_POINT_XXX
+    typedef TInformationObject<uint8_t> TDoublePointInformationObject;
+
+    typedef TInformationObject<uint32_t> TBitStringInformationObject;
+
+    // Types with the same value type as other types are distinct, as encoding is selected by information object type
+
+    //! Value is in range [-1, 1]
+    struct TMeasuredValueNormalizedInformationObject: public TInformationObject<float>
+    {
+        using TInformationObject<float>::TInformationObject;
+    };
+
+    //! Value is in range [STEP_POSITION_MIN, STEP_POSITION_MAX]
+    struct TStepPositionInformationObject: public TInformationObject<int>
+    {
+        using TInformationObject<int>::TInformationObject;
+    };
+
     typedef TInformationObjectWithTimestamp<bool> TSinglePointInformationObjectWithTimestamp;
     typedef TInformationObjectWithTimestamp<float> TMeasuredValueShortInformationObjectWithTimestamp;
     typedef TInformationObjectWithTimestamp<int> TMeasuredValueScaledInformationObjectWithTimestamp;
 
+    //! Integrated totals (counter reading). Counters are transmitted only on counter interrogation
+    struct TIntegratedTotalsInformationObject
+    {
+        uint32_t Address;
+        int32_t Value;
+
+        //! Counter interrogation response contains time of freeze (M_IT_TB_1)
+        bool WithTimestamp;
+
+        //! Only QUALITY_INVALID bit is transmitted with binary counter reading
+        uint8_t Quality;
+
+        TIntegratedTotalsInformationObject(uint32_t address,
+                                           int32_t value,
+                                           bool withTimestamp,
+                                           uint8_t quality = QUALITY_GOOD)
+            : Address(address),
+              Value(value),
+              WithTimestamp(withTimestamp),
+              Quality(quality)
+        {}
+    };
+
     //! IEC information objects. Vectors of pairs "information object address"-"value"
     struct TInformationObjects
     {
         std::vector<TSinglePointInformationObject> SinglePoint;
         std::vector<TMeasuredValueShortInformationObject> MeasuredValueShort;
         std::vector<TMeasuredValueScaledInformationObject> MeasuredValueScaled;
+        std::vector<TDoublePointInformationObject> DoublePoint;
+        std::vector<TMeasuredValueNormalizedInformationObject> MeasuredValueNormalized;
+        std::vector<TBitStringInformationObject> BitString;
+        std::vector<TStepPositionInformationObject> StepPosition;
         std::vector<TSinglePointInformationObjectWithTimestamp> SinglePointWithTimestamp;
         std::vector<TMeasuredValueShortInformationObjectWithTimestamp> MeasuredValueShortWithTimestamp;
         std::vector<TMeasuredValueScaledInformationObjectWithTimestamp> MeasuredValueScaledWithTimestamp;
+
+        //! Current counter readings. They are not sent spontaneously and on station interrogation
+        std::vector<TIntegratedTotalsInformationObject> IntegratedTotals;
+    };
+
+    //! Value of information object received with IEC command
+    struct TCommandValue
+    {
+        uint32_t Address;
+
+        //! Regulating step command: -1 - next step lower, 1 - next step higher. 0 - Value is set
+        int Step = 0;
+
+        //! MQTT representation of the value. It is formatted in place, so commands don't allocate strings
+        std::array<char, ValueFormatter::MAX_SIZE> Value;
+        size_t ValueSize = 0;
     };
 
     //! Interface of external event handler
@@ -68,20 +242,23 @@ namespace IEC104
     public:
         virtual ~IHandler() = default;
 
-        //! Return values of all information objects. Must be threadsafe.
+        //! Return last known values of all information objects. Objects without known values have QUALITY_INVALID.
+        //! Must be threadsafe and must not block for long, as it is called from IEC connection threads.
         virtual TInformationObjects GetInformationObjectsValues() const noexcept = 0;
 
         /**
-         * @brief Process value received with IEC command.
-         *        Must be threadsafe.
+         * @brief Process values received with IEC command. All information objects of a command ASDU
+         *        are processed together. Must be threadsafe.
          *
-         * @param ioa information object address of command
-         * @param value value received from command
-         * @return true - received value successfully processed by handler. Positive acknowledgement to command will be
+         * @param values values received from command
+         * @return true - received values successfully processed by handler. Positive acknowledgement to command will be
          * send
          * @return false - an error occurred during processing. Negative response to command will be send
+         *
+         * The method is called from command execution thread of the master connection and may block until the values
+         * are set. Commands of different connections are processed simultaneously.
          */
-        virtual bool SetParameter(uint32_t ioa, const std::string& value) noexcept = 0;
+        virtual bool SetParameters(const std::vector<TCommandValue>& values) noexcept = 0;
     };
 
     //! Interface of IEC104 server. Note that in IEC terms a server is a controlling unit (slave)
@@ -101,10 +278,29 @@ namespace IEC104
          */
         virtual void SendSpontaneous(const TInformationObjects& obj) = 0;
 
+        /**
+         * @brief Update values of information objects returned on interrogation without spontaneous transmission.
+         *        Must be threadsafe.
+         *
+         * @param obj information objects to update
+         */
+        virtual void UpdateValues(const TInformationObjects& obj) = 0;
+
+        /**
+         * @brief Replace the set of information objects after configuration change without dropping connections.
+         *        Only settings of information objects and stations are applied: interrogation groups,
+         *        cycle periods, select timeouts, sequence encoding and common addresses.
+         *        Must be threadsafe.
+         *
+         * @param config new configuration
+         * @param objs values of all configured information objects
+         */
+        virtual void Reconfigure(const TServerConfig& config, const TInformationObjects& objs) = 0;
+
         /**
          * @brief Set the Handler object for commands. The server doesn't own handler object.
          *        Handler object must be available during all lifetime of the server.
-         *        Handler object can be set only once.
+         *        Handler object can be set only once. The server accepts connections after the handler is set.
          */
         virtual void SetHandler(IHandler* handler) = 0;
     };
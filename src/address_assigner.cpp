@@ -0,0 +1,44 @@
+#include "address_assigner.h"
+
+#include <stdexcept>
+
+#include "murmurhash.h"
+
+namespace
+{
+    const uint32_t ADDRESS_MASK = 0xFFFFFF;
+    const uint32_t ADDRESS_SEED = 0xA30AA568;
+
+    // The step is odd, so probing visits all addresses of 2^24 space before repeating
+    const uint32_t ADDRESS_SALT = 7079;
+}
+
+TAddressAssigner::TAddressAssigner(): UsedAddresses((ADDRESS_MASK + 1) / 64)
+{
+    Reserve(0);
+}
+
+void TAddressAssigner::Reserve(uint32_t address)
+{
+    if (address <= ADDRESS_MASK) {
+        UsedAddresses[address / 64] |= uint64_t(1) << (address % 64);
+    }
+}
+
+bool TAddressAssigner::IsUsed(uint32_t address) const
+{
+    return address <= ADDRESS_MASK && (UsedAddresses[address / 64] & (uint64_t(1) << (address % 64)));
+}
+
+uint32_t TAddressAssigner::GetAddress(const std::string& topic)
+{
+    uint32_t address = MurmurHash2A((const uint8_t*)topic.data(), topic.size(), ADDRESS_SEED) & ADDRESS_MASK;
+    for (uint32_t i = 0; i <= ADDRESS_MASK; ++i) {
+        if (!IsUsed(address)) {
+            Reserve(address);
+            return address;
+        }
+        address = (address + ADDRESS_SALT) & ADDRESS_MASK;
+    }
+    throw std::runtime_error("All information object addresses are used");
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Generator of unique information object addresses for MQTT controls.
+ *        An address is derived from hash of control's topic, on collision following candidates are probed
+ *        with a fixed step. Occupancy of the whole 24-bit address space is kept in a bitmap, so a probe costs O(1)
+ *        regardless of number of used addresses. Address 0 is never assigned.
+ *        The class is not threadsafe.
+ */
+class TAddressAssigner
+{
+public:
+    TAddressAssigner();
+
+    //! Mark the address as used. Addresses out of 24-bit range are ignored
+    void Reserve(uint32_t address);
+
+    bool IsUsed(uint32_t address) const;
+
+    //! Get unused address for the topic and mark it as used. Throws std::runtime_error if all addresses are used
+    uint32_t GetAddress(const std::string& topic);
+
+private:
+    std::vector<uint64_t> UsedAddresses;
+};
@@ -0,0 +1,51 @@
+#include "command_selections.h"
+
+IEC104::TCommandSelections::TCommandSelections(std::chrono::milliseconds timeout, const TSelectTimeouts& timeouts)
+    : Timeout(timeout),
+      Timeouts(timeouts)
+{}
+
+bool IEC104::TCommandSelections::IsAvailable(uint64_t connectionId, uint32_t address, const TTimePoint& now) const
+{
+    auto it = Selections.find(address);
+    return (it == Selections.end() || it->second.ConnectionId == connectionId || it->second.Deadline <= now);
+}
+
+void IEC104::TCommandSelections::Select(uint64_t connectionId, uint32_t address, const TTimePoint& now)
+{
+    auto it = Timeouts.find(address);
+    auto timeout = (it == Timeouts.end() ? Timeout : it->second);
+    // Zero timeout keeps the selection until execution, deselection or disconnection
+    auto deadline = (timeout.count() ? now + timeout : TTimePoint::max());
+    Selections[address] = TSelection{connectionId, deadline};
+}
+
+void IEC104::TCommandSelections::Release(uint64_t connectionId, uint32_t address)
+{
+    auto it = Selections.find(address);
+    if (it != Selections.end() && it->second.ConnectionId == connectionId) {
+        Selections.erase(it);
+    }
+}
+
+void IEC104::TCommandSelections::ReleaseAll(uint64_t connectionId)
+{
+    for (auto it = Selections.begin(); it != Selections.end();) {
+        if (it->second.ConnectionId == connectionId) {
+            it = Selections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void IEC104::TCommandSelections::SetTimeouts(std::chrono::milliseconds timeout, const TSelectTimeouts& timeouts)
+{
+    Timeout = timeout;
+    Timeouts = timeouts;
+}
+
+size_t IEC104::TCommandSelections::Size() const
+{
+    return Selections.size();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+#include "IEC104Server.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Information objects selected by select commands (S/E = 1) of select-before-operate procedure.
+     *        A selected object is reserved for the connection until the connection executes or deselects it,
+     *        or its select timeout expires. Objects which are not selected can be executed directly.
+     *        The class is not threadsafe.
+     */
+    class TCommandSelections
+    {
+    public:
+        typedef std::chrono::steady_clock::time_point TTimePoint;
+
+        /**
+         * @param timeout select timeout of objects without own timeout
+         * @param timeouts select timeouts of information objects
+         */
+        TCommandSelections(std::chrono::milliseconds timeout, const TSelectTimeouts& timeouts = {});
+
+        //! The object is not selected by another connection
+        bool IsAvailable(uint64_t connectionId, uint32_t address, const TTimePoint& now) const;
+
+        //! Select the object for the connection. The object must be available
+        void Select(uint64_t connectionId, uint32_t address, const TTimePoint& now);
+
+        //! Remove selection of the object if it is selected by the connection
+        void Release(uint64_t connectionId, uint32_t address);
+
+        //! Remove all selections of the connection
+        void ReleaseAll(uint64_t connectionId);
+
+        //! Replace select timeouts, current selections are kept
+        void SetTimeouts(std::chrono::milliseconds timeout, const TSelectTimeouts& timeouts);
+
+        //! Number of selected objects including expired ones
+        size_t Size() const;
+
+    private:
+        struct TSelection
+        {
+            uint64_t ConnectionId;
+            TTimePoint Deadline;
+        };
+
+        std::chrono::milliseconds Timeout;
+        TSelectTimeouts Timeouts;
+        std::unordered_map<uint32_t, TSelection> Selections;
+    };
+}
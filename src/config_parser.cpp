@@ -11,9 +11,10 @@
 #include <wblib/json_utils.h>
 #include <wblib/wbmqtt.h>
 
+#include "address_assigner.h"
 #include "iec104_exception.h"
 #include "log.h"
-#include "murmurhash.h"
+#include "statistics_publisher.h"
 
 using namespace std;
 using namespace WBMQTT;
@@ -29,6 +30,12 @@ namespace
     const std::string SINGLE_POINT_WITH_TIMESTAMP_CONFIG_VALUE("single_time");
     const std::string MEASURED_VALUE_SHORT_WITH_TIMESTAMP_CONFIG_VALUE("short_time");
     const std::string MEASURED_VALUE_SCALED_WITH_TIMESTAMP_CONFIG_VALUE("scaled_time");
+    const std::string INTEGRATED_TOTALS_CONFIG_VALUE("counter");
+    const std::string INTEGRATED_TOTALS_WITH_TIMESTAMP_CONFIG_VALUE("counter_time");
+    const std::string DOUBLE_POINT_CONFIG_VALUE("double");
+    const std::string MEASURED_VALUE_NORMALIZED_CONFIG_VALUE("normalized");
+    const std::string BITSTRING_CONFIG_VALUE("bitstring");
+    const std::string STEP_POSITION_CONFIG_VALUE("step");
 
     const std::unordered_map<std::string, TIecInformationObjectType> Types = {
         {SINGLE_POINT_CONFIG_VALUE, SinglePoint},
@@ -36,7 +43,13 @@ namespace
         {MEASURED_VALUE_SCALED_CONFIG_VALUE, MeasuredValueScaled},
         {SINGLE_POINT_WITH_TIMESTAMP_CONFIG_VALUE, SinglePointWithTimestamp},
         {MEASURED_VALUE_SHORT_WITH_TIMESTAMP_CONFIG_VALUE, MeasuredValueShortWithTimestamp},
-        {MEASURED_VALUE_SCALED_WITH_TIMESTAMP_CONFIG_VALUE, MeasuredValueScaledWithTimestamp}};
+        {MEASURED_VALUE_SCALED_WITH_TIMESTAMP_CONFIG_VALUE, MeasuredValueScaledWithTimestamp},
+        {INTEGRATED_TOTALS_CONFIG_VALUE, IntegratedTotals},
+        {INTEGRATED_TOTALS_WITH_TIMESTAMP_CONFIG_VALUE, IntegratedTotalsWithTimestamp},
+        {DOUBLE_POINT_CONFIG_VALUE, DoublePoint},
+        {MEASURED_VALUE_NORMALIZED_CONFIG_VALUE, MeasuredValueNormalized},
+        {BITSTRING_CONFIG_VALUE, BitString},
+        {STEP_POSITION_CONFIG_VALUE, StepPosition}};
 
     TIecInformationObjectType GetIoType(const std::string& t)
     {
@@ -63,7 +76,18 @@ namespace
         return (l.size() == 2);
     }
 
-    void LoadControls(TDeviceConfig& config, const Json::Value& controls, std::set<uint32_t>& UsedAddresses)
+    bool IsCyclicType(TIecInformationObjectType type)
+    {
+        return (type == MeasuredValueShort || type == MeasuredValueScaled || type == MeasuredValueNormalized);
+    }
+
+    void LoadControls(TDeviceConfig& config,
+                      IEC104::TServerConfig& iecConfig,
+                      const Json::Value& controls,
+                      int interrogationGroup,
+                      int cycleMs,
+                      int commonAddress,
+                      std::set<uint32_t>& UsedAddresses)
     {
         for (const auto& control: controls) {
             bool enabled = false;
@@ -76,8 +100,39 @@ namespace
                         LOG(Warn) << "Control '" << topic << "' has duplicate address " << ioa;
                     } else {
                         UsedAddresses.insert(ioa);
-                        config[GetDeviceName(topic)].insert(
-                            {GetControlName(topic), {ioa, GetIoType(control["iec_type"].asString())}});
+                        TIecInformationObject obj{ioa, GetIoType(control["iec_type"].asString())};
+                        Get(control, "deadband", obj.Deadband);
+                        Get(control, "deadband_percent", obj.DeadbandPercent);
+                        int sendInterval = 0;
+                        Get(control, "send_interval_ms", sendInterval);
+                        obj.SendInterval = std::chrono::milliseconds(sendInterval);
+                        Get(control, "counter_scale", obj.CounterScale);
+                        int staleTimeout = 0;
+                        Get(control, "stale_timeout_s", staleTimeout);
+                        obj.StaleTimeout = std::chrono::seconds(staleTimeout);
+                        int controlInterrogationGroup = interrogationGroup;
+                        Get(control, "interrogation_group", controlInterrogationGroup);
+                        if (controlInterrogationGroup) {
+                            iecConfig.InterrogationGroups[ioa] = controlInterrogationGroup;
+                        }
+                        int controlCycleMs = cycleMs;
+                        Get(control, "cycle_ms", controlCycleMs);
+                        if (controlCycleMs) {
+                            if (IsCyclicType(obj.Type)) {
+                                iecConfig.CyclePeriods[ioa] = std::chrono::milliseconds(controlCycleMs);
+                            } else if (control.isMember("cycle_ms")) {
+                                LOG(Warn) << "Control '" << topic << "' has cycle_ms, but only short, scaled and "
+                                          << "normalized values are sent periodically";
+                            }
+                        }
+                        if (commonAddress) {
+                            iecConfig.CommonAddresses[ioa] = commonAddress;
+                        }
+                        if (control.isMember("select_timeout_ms")) {
+                            iecConfig.SelectTimeouts[ioa] =
+                                std::chrono::milliseconds(control["select_timeout_ms"].asInt());
+                        }
+                        config[GetDeviceName(topic)].insert({GetControlName(topic), obj});
                     }
                 } else {
                     LOG(Warn) << "Control '" << topic << "' has invalid topic name";
@@ -86,7 +141,9 @@ namespace
         }
     }
 
-    TDeviceConfig LoadGroups(const Json::Value& config, std::set<uint32_t>& UsedAddresses)
+    TDeviceConfig LoadGroups(const Json::Value& config,
+                             IEC104::TServerConfig& iecConfig,
+                             std::set<uint32_t>& UsedAddresses)
     {
         TDeviceConfig res;
         bool anyEnabled = false;
@@ -95,7 +152,20 @@ namespace
             Get(group, "enabled", enabled);
             if (enabled) {
                 anyEnabled = true;
-                LoadControls(res, group["controls"], UsedAddresses);
+                int interrogationGroup = 0;
+                Get(group, "interrogation_group", interrogationGroup);
+                int cycleMs = 0;
+                Get(group, "cycle_ms", cycleMs);
+                // Controls of groups without common address belong to the station of iec104 section
+                int commonAddress = 0;
+                Get(group, "common_address", commonAddress);
+                LoadControls(res,
+                             iecConfig,
+                             group["controls"],
+                             interrogationGroup,
+                             cycleMs,
+                             commonAddress,
+                             UsedAddresses);
             }
         }
         if (!anyEnabled) {
@@ -121,32 +191,6 @@ namespace
         return cfg;
     }
 
-    class AddressAssigner
-    {
-        std::set<uint32_t> UsedAddresses;
-
-    public:
-        AddressAssigner(const Json::Value& config)
-        {
-            for (const auto& device: config["devices"]) {
-                for (const auto& control: device["controls"]) {
-                    UsedAddresses.insert(control["address"].asUInt());
-                }
-            }
-        }
-
-        uint32_t GetAddress(const std::string& topicName)
-        {
-            uint32_t newAddr = MurmurHash2A((const uint8_t*)topicName.data(), topicName.size(), 0xA30AA568) & 0xFFFFFF;
-            const uint32_t ADDR_SALT = 7079;
-            while (UsedAddresses.count(newAddr)) {
-                newAddr = (newAddr + ADDR_SALT) & 0xFFFFFF;
-            }
-            UsedAddresses.insert(newAddr);
-            return newAddr;
-        }
-    };
-
     bool IsConvertibleControl(PControl control)
     {
         return (control->GetType() != "text" && control->GetType() != "rgb");
@@ -166,7 +210,7 @@ namespace
         return cnt;
     }
 
-    void AppendControl(Json::Value& root, PControl c, AddressAssigner& aa)
+    void AppendControl(Json::Value& root, PControl c, TAddressAssigner& aa)
     {
         if (!IsConvertibleControl(c)) {
             ::Warn.Log() << "'" << c->GetId() << "' of type '" << c->GetType() << "' from device '"
@@ -187,7 +231,7 @@ namespace
             MakeControlConfig(controlName, info, aa.GetAddress(controlName), MEASURED_VALUE_SHORT_CONFIG_VALUE));
     }
 
-    Json::Value MakeControlsConfig(std::map<std::string, PControl>& controls, AddressAssigner& addressAssigner)
+    Json::Value MakeControlsConfig(std::map<std::string, PControl>& controls, TAddressAssigner& addressAssigner)
     {
         Json::Value res(Json::arrayValue);
         for (auto control: controls) {
@@ -205,14 +249,40 @@ namespace
         return dev;
     }
 
-    Json::Value& GetGroup(Json::Value& config, const std::string& name)
+    //! Finds groups of config by name and appends missing ones
+    class TGroupIndex
+    {
+        Json::Value& Groups;
+        std::unordered_map<std::string, Json::ArrayIndex> Positions;
+
+    public:
+        TGroupIndex(Json::Value& config): Groups(config["groups"])
+        {
+            for (Json::ArrayIndex i = 0; i < Groups.size(); ++i) {
+                Positions.emplace(Groups[i]["name"].asString(), i);
+            }
+        }
+
+        Json::Value& GetGroup(const std::string& name)
+        {
+            auto it = Positions.find(name);
+            if (it != Positions.end()) {
+                return Groups[it->second];
+            }
+            Positions.emplace(name, Groups.size());
+            return Groups.append(MakeGroupConfig(name));
+        }
+    };
+
+    TAddressAssigner MakeAddressAssigner(const Json::Value& config)
     {
-        for (auto& group: config["groups"]) {
-            if (group["name"].asString() == name) {
-                return group;
+        TAddressAssigner res;
+        for (const auto& group: config["groups"]) {
+            for (const auto& control: group["controls"]) {
+                res.Reserve(control["address"].asUInt());
             }
         }
-        return config["groups"].append(MakeGroupConfig(name));
+        return res;
     }
 }
 
@@ -227,9 +297,48 @@ TConfig LoadConfig(const std::string& configFileName, const std::string& configS
         cfg.Iec.BindIp = config["iec104"]["host"].asString();
         cfg.Iec.BindPort = config["iec104"]["port"].asUInt();
         cfg.Iec.CommonAddress = config["iec104"]["address"].asUInt();
+        int coalesceWindowMs = 0;
+        Get(config["iec104"], "coalesce_window_ms", coalesceWindowMs);
+        cfg.Iec.CoalesceWindow = std::chrono::milliseconds(coalesceWindowMs);
+        int coalesceMaxObjects = cfg.Iec.CoalesceMaxObjects;
+        Get(config["iec104"], "coalesce_max_objects", coalesceMaxObjects);
+        cfg.Iec.CoalesceMaxObjects = coalesceMaxObjects;
+        Get(config["iec104"], "keep_events_history", cfg.Iec.KeepEventsHistory);
+        int maxPendingCommands = cfg.Iec.MaxPendingCommands;
+        Get(config["iec104"], "max_pending_commands", maxPendingCommands);
+        cfg.Iec.MaxPendingCommands = maxPendingCommands;
+        Get(config["iec104"], "send_act_term", cfg.Iec.SendActTerm);
+        int queueSize = cfg.Iec.QueueSize;
+        Get(config["iec104"], "queue_size", queueSize);
+        cfg.Iec.QueueSize = queueSize;
+        Get(config["iec104"], "journal_file", cfg.Iec.JournalFile);
+        int journalSize = cfg.Iec.JournalSize;
+        Get(config["iec104"], "journal_size", journalSize);
+        cfg.Iec.JournalSize = journalSize;
+        if (config["iec104"].get("journal_overflow", "drop_oldest").asString() == "drop_newest") {
+            cfg.Iec.JournalOverflowPolicy = IEC104::TJournalOverflowPolicy::DropNewest;
+        }
+        int maxConnections = cfg.Iec.MaxConnections;
+        Get(config["iec104"], "max_connections", maxConnections);
+        cfg.Iec.MaxConnections = maxConnections;
+        Get(config["iec104"], "sequence_encoding", cfg.Iec.SequenceEncoding);
+        int selectTimeoutMs = cfg.Iec.SelectTimeout.count();
+        Get(config["iec104"], "select_timeout_ms", selectTimeoutMs);
+        cfg.Iec.SelectTimeout = std::chrono::milliseconds(selectTimeoutMs);
+        for (const auto& group: config["iec104"]["redundancy_groups"]) {
+            IEC104::TRedundancyGroup redundancyGroup;
+            redundancyGroup.Name = group["name"].asString();
+            for (const auto& client: group["clients"]) {
+                redundancyGroup.AllowedClients.push_back(client.asString());
+            }
+            cfg.Iec.RedundancyGroups.push_back(redundancyGroup);
+        }
         cfg.Mqtt = LoadMqttConfig(config);
-        cfg.Devices = LoadGroups(config, usedAddresses);
+        cfg.Devices = LoadGroups(config, cfg.Iec, usedAddresses);
         Get(config, "debug", cfg.Debug);
+        int statisticsInterval = cfg.StatisticsInterval.count();
+        Get(config, "statistics_interval_s", statisticsInterval);
+        cfg.StatisticsInterval = std::chrono::seconds(statisticsInterval);
         return cfg;
     } catch (const TEmptyConfigException& e) {
         throw;
@@ -273,12 +382,13 @@ void UpdateConfig(PDeviceDriver driver, Json::Value& oldConfig)
     driver->SetFilter(GetAllDevicesFilter());
     driver->WaitForReady();
 
-    AddressAssigner addressAssigner(oldConfig);
+    auto addressAssigner(MakeAddressAssigner(oldConfig));
 
     std::map<std::string, std::map<std::string, PControl>> mqttDevices;
     auto tx = driver->BeginTx();
     for (auto& device: tx->GetDevicesList()) {
-        if (!WBMQTT::StringStartsWith(device->GetId(), "system__")) {
+        // Retained statistics of the gateway itself are not controls to be sent
+        if (!WBMQTT::StringStartsWith(device->GetId(), "system__") && device->GetId() != STATISTICS_DEVICE_ID) {
             std::map<std::string, PControl> controls;
             for (auto& control: device->ControlsList()) {
                 controls.insert({control->GetId(), control});
@@ -295,22 +405,20 @@ void UpdateConfig(PDeviceDriver driver, Json::Value& oldConfig)
             if (IsValidTopic(topic)) {
                 auto mqttDevice = mqttDevices.find(GetDeviceName(topic));
                 if (mqttDevice != mqttDevices.end()) {
-                    auto mqttControl = mqttDevice->second.find(GetControlName(topic));
-                    if (mqttControl != mqttDevice->second.end()) {
-                        mqttDevice->second.erase(mqttControl);
+                    mqttDevice->second.erase(GetControlName(topic));
+                    if (mqttDevice->second.empty()) {
+                        mqttDevices.erase(mqttDevice);
                     }
                 }
-                if (!mqttDevice->second.size()) {
-                    mqttDevices.erase(mqttDevice);
-                }
             }
         }
     }
 
+    TGroupIndex groups(oldConfig);
     for (auto& mqttDevice: mqttDevices) {
         auto controls(MakeControlsConfig(mqttDevice.second, addressAssigner));
         if (controls.size()) {
-            auto& configGroup = GetGroup(oldConfig, mqttDevice.first);
+            auto& configGroup = groups.GetGroup(mqttDevice.first);
             for (auto& v: controls) {
                 configGroup["controls"].append(v);
             }
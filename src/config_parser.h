@@ -7,6 +7,9 @@ struct TConfig
     WBMQTT::TMosquittoMqttConfig Mqtt;
     TDeviceConfig Devices;
     bool Debug = false;
+
+    //! Runtime statistics publishing interval. Zero disables publishing
+    std::chrono::seconds StatisticsInterval = std::chrono::seconds(10);
 };
 
 TConfig LoadConfig(const std::string& configFileName, const std::string& configSchemaFileName);
@@ -0,0 +1,133 @@
+#include "counters.h"
+
+#include "information_objects_internal.h"
+
+namespace
+{
+    // Sequence number of binary counter reading has 5 bits
+    const uint8_t SEQUENCE_NUMBER_MASK = 0x1F;
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TCounterReading& obj)
+{
+    sBinaryCounterReading bcr;
+    BinaryCounterReading_create(&bcr, obj.Value, obj.SequenceNumber, false, false, obj.Invalid);
+    sIntegratedTotals storage;
+    auto io = IntegratedTotals_create(&storage, obj.Address, &bcr);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TCounterReadingWithTimestamp& obj)
+{
+    sBinaryCounterReading bcr;
+    BinaryCounterReading_create(&bcr, obj.Value, obj.SequenceNumber, false, false, obj.Invalid);
+    sIntegratedTotalsWithCP56Time2a storage;
+    auto timestamp = MakeTimestamp(obj.Timestamp);
+    auto io = IntegratedTotalsWithCP56Time2a_create(&storage, obj.Address, &bcr, &timestamp);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+uint8_t IEC104::GetCounterGroup(uint8_t rqt)
+{
+    return (rqt == IEC60870_QCC_RQT_GENERAL) ? 0 : rqt;
+}
+
+CS101_CauseOfTransmission IEC104::GetCounterInterrogationCot(uint8_t rqt)
+{
+    if (rqt == IEC60870_QCC_RQT_GENERAL) {
+        return CS101_COT_REQUESTED_BY_GENERAL_COUNTER;
+    }
+    return static_cast<CS101_CauseOfTransmission>(CS101_COT_REQUESTED_BY_GROUP_1_COUNTER + (rqt - 1));
+}
+
+IEC104::TCounters::TCounters(const TInterrogationGroups& groups): Groups(groups)
+{}
+
+int32_t IEC104::TCounters::GetReading(const TCounter& counter)
+{
+    // Counter readings roll over like binary counters do
+    return static_cast<int32_t>(static_cast<uint32_t>(counter.Current) - static_cast<uint32_t>(counter.Base));
+}
+
+void IEC104::TCounters::Update(const std::vector<TIntegratedTotalsInformationObject>& objs)
+{
+    for (const auto& obj: objs) {
+        auto it = Positions.find(obj.Address);
+        if (it != Positions.end()) {
+            Counters[it->second].Current = obj.Value;
+            Counters[it->second].Invalid = (obj.Quality & QUALITY_INVALID) != 0;
+            continue;
+        }
+        TCounter counter;
+        counter.Address = obj.Address;
+        auto group = Groups.find(obj.Address);
+        counter.Group = (group != Groups.end()) ? group->second : 0;
+        counter.WithTimestamp = obj.WithTimestamp;
+        counter.Current = obj.Value;
+        counter.Base = 0;
+        counter.Invalid = (obj.Quality & QUALITY_INVALID) != 0;
+        Positions.emplace(obj.Address, Counters.size());
+        Counters.push_back(counter);
+    }
+}
+
+void IEC104::TCounters::Reconfigure(const TInterrogationGroups& groups,
+                                    const std::vector<TIntegratedTotalsInformationObject>& objs)
+{
+    std::vector<TCounter> counters;
+    std::unordered_map<uint32_t, size_t> positions;
+    for (const auto& obj: objs) {
+        auto it = Positions.find(obj.Address);
+        if (it != Positions.end() && Counters[it->second].WithTimestamp == obj.WithTimestamp) {
+            counters.push_back(Counters[it->second]);
+        } else {
+            TCounter counter;
+            counter.Address = obj.Address;
+            counter.WithTimestamp = obj.WithTimestamp;
+            counter.Base = 0;
+            counters.push_back(counter);
+        }
+        auto& counter = counters.back();
+        auto group = groups.find(obj.Address);
+        counter.Group = (group != groups.end()) ? group->second : 0;
+        counter.Current = obj.Value;
+        counter.Invalid = (obj.Quality & QUALITY_INVALID) != 0;
+        positions.emplace(obj.Address, counters.size() - 1);
+    }
+    Groups = groups;
+    Counters.swap(counters);
+    Positions.swap(positions);
+}
+
+void IEC104::TCounters::Freeze(uint8_t group, bool reset, const std::chrono::system_clock::time_point& time)
+{
+    for (auto& counter: Counters) {
+        if (group && counter.Group != group) {
+            continue;
+        }
+        counter.IsFrozen = true;
+        counter.Frozen = GetReading(counter);
+        counter.FrozenInvalid = counter.Invalid;
+        counter.FreezeTime = time;
+        counter.SequenceNumber = (counter.SequenceNumber + 1) & SEQUENCE_NUMBER_MASK;
+        if (reset) {
+            counter.Base = counter.Current;
+        }
+    }
+}
+
+void IEC104::TCounters::Reset(uint8_t group)
+{
+    for (auto& counter: Counters) {
+        if (group && counter.Group != group) {
+            continue;
+        }
+        counter.Base = counter.Current;
+        counter.SequenceNumber = (counter.SequenceNumber + 1) & SEQUENCE_NUMBER_MASK;
+    }
+}
+
+size_t IEC104::TCounters::Size() const
+{
+    return Counters.size();
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "information_object_encoder.h"
+
+namespace IEC104
+{
+    //! Frozen counter reading as it is sent on counter interrogation
+    struct TCounterReading
+    {
+        uint32_t Address;
+        int32_t Value;
+        uint8_t SequenceNumber;
+        bool Invalid;
+    };
+
+    struct TCounterReadingWithTimestamp: public TCounterReading
+    {
+        std::chrono::system_clock::time_point Timestamp;
+    };
+
+    template<> struct TInformationObjectTraits<TCounterReading>
+    {
+        static constexpr TypeID Type = M_IT_NA_1;
+    };
+
+    template<> struct TInformationObjectTraits<TCounterReadingWithTimestamp>
+    {
+        static constexpr TypeID Type = M_IT_TB_1;
+    };
+
+    bool AddInformationObject(CS101_ASDU asdu, const TCounterReading& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TCounterReadingWithTimestamp& obj);
+
+    //! Counter group 1-4 requested by RQT of counter interrogation qualifier, 0 - general request (RQT 5)
+    uint8_t GetCounterGroup(uint8_t rqt);
+
+    //! COT of counter interrogation response: 37 for general request (RQT 5), 38-41 for counter groups 1-4
+    CS101_CauseOfTransmission GetCounterInterrogationCot(uint8_t rqt);
+
+    /**
+     * @brief Current and frozen readings of counters for counter interrogation (C_CI_NA_1).
+     *        Freeze copies current readings to frozen ones in memory, so reading of frozen counters
+     *        doesn't touch other information objects. Reset sets zero point of a counter to its current reading,
+     *        so further readings are relative to it. Sequence number of a counter is incremented on every freeze
+     *        or reset. Counters of groups 1-4 also belong to counter groups with the same numbers.
+     *        The class is not threadsafe.
+     */
+    class TCounters
+    {
+    public:
+        TCounters(const TInterrogationGroups& groups);
+
+        //! Set current readings of counters. Unknown counters are added
+        void Update(const std::vector<TIntegratedTotalsInformationObject>& objs);
+
+        /**
+         * @brief Replace the set of counters after configuration change. Counters with the same address and type
+         *        keep their frozen readings, zero points and sequence numbers, other counters are dropped
+         */
+        void Reconfigure(const TInterrogationGroups& groups,
+                         const std::vector<TIntegratedTotalsInformationObject>& objs);
+
+        /**
+         * @brief Freeze current readings of counters
+         *
+         * @param group counter group 1-4, 0 - all counters
+         * @param reset reset counters after freeze
+         * @param time time of freeze, it is sent with readings of counters with timestamp
+         */
+        void Freeze(uint8_t group, bool reset, const std::chrono::system_clock::time_point& time);
+
+        //! Reset counters of the group (1-4, 0 - all counters) without freeze
+        void Reset(uint8_t group);
+
+        /**
+         * @brief Pack frozen readings of counters of the group (1-4, 0 - all counters) into ASDUs and pass them
+         *        to sendFn. Counters which have never been frozen are sent with current readings
+         */
+        template<class TSendFn>
+        void Send(CS101_AppLayerParameters appLayerParameters,
+                  int commonAddress,
+                  uint8_t group,
+                  CS101_CauseOfTransmission cot,
+                  TSendFn&& sendFn) const
+        {
+            TAsduWriter<TSendFn> writer(appLayerParameters, cot, commonAddress, sendFn);
+            auto now = std::chrono::system_clock::now();
+            // Counters with and without timestamp are sent in separate passes to fill ASDUs of the same type
+            for (bool withTimestamp: {false, true}) {
+                for (const auto& counter: Counters) {
+                    if ((group && counter.Group != group) || counter.WithTimestamp != withTimestamp) {
+                        continue;
+                    }
+                    TCounterReadingWithTimestamp reading;
+                    reading.Address = counter.Address;
+                    reading.SequenceNumber = counter.SequenceNumber;
+                    if (counter.IsFrozen) {
+                        reading.Value = counter.Frozen;
+                        reading.Invalid = counter.FrozenInvalid;
+                        reading.Timestamp = counter.FreezeTime;
+                    } else {
+                        reading.Value = GetReading(counter);
+                        reading.Invalid = counter.Invalid;
+                        reading.Timestamp = now;
+                    }
+                    if (withTimestamp) {
+                        writer.Append(reading);
+                    } else {
+                        writer.Append(static_cast<const TCounterReading&>(reading));
+                    }
+                }
+            }
+            writer.Flush();
+        }
+
+        //! Number of counters
+        size_t Size() const;
+
+    private:
+        struct TCounter
+        {
+            uint32_t Address;
+            uint8_t Group;
+            bool WithTimestamp;
+            int32_t Current;
+            int32_t Base; // Reading of last reset
+            bool Invalid;
+            bool IsFrozen = false;
+            int32_t Frozen = 0;
+            bool FrozenInvalid = false;
+            std::chrono::system_clock::time_point FreezeTime;
+            uint8_t SequenceNumber = 0; // 0-31
+        };
+
+        TInterrogationGroups Groups;
+        std::vector<TCounter> Counters;
+        std::unordered_map<uint32_t, size_t> Positions; // Maps information object address to index in Counters
+
+        static int32_t GetReading(const TCounter& counter);
+    };
+}
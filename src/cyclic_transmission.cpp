@@ -0,0 +1,63 @@
+#include "cyclic_transmission.h"
+
+namespace
+{
+    const size_t CYCLIC_TIMER_BUCKETS = 128;
+}
+
+IEC104::TCyclicTransmission::TCyclicTransmission(const TCyclePeriods& periods, const TTimePoint& start)
+    : Timers(CYCLIC_TIMER_BUCKETS, TICK, start)
+{
+    Objects.reserve(periods.size());
+    for (const auto& period: periods) {
+        if (period.second <= std::chrono::milliseconds::zero()) {
+            continue;
+        }
+        TObject obj;
+        obj.Address = period.first;
+        obj.Period = period.second;
+        obj.Deadline = start + period.second;
+        Positions.emplace(obj.Address, Objects.size());
+        Timers.Add(Objects.size(), obj.Deadline);
+        Objects.push_back(obj);
+    }
+}
+
+void IEC104::TCyclicTransmission::Update(const TInformationObjects& objs)
+{
+    if (Objects.empty()) {
+        return;
+    }
+    for (const auto& v: objs.MeasuredValueShort) {
+        auto it = Positions.find(v.Address);
+        if (it != Positions.end()) {
+            auto& obj = Objects[it->second];
+            obj.ValueType = TValueType::Short;
+            obj.FloatValue = v.Value;
+            obj.Quality = v.Quality;
+        }
+    }
+    for (const auto& v: objs.MeasuredValueScaled) {
+        auto it = Positions.find(v.Address);
+        if (it != Positions.end()) {
+            auto& obj = Objects[it->second];
+            obj.ValueType = TValueType::Scaled;
+            obj.IntValue = v.Value;
+            obj.Quality = v.Quality;
+        }
+    }
+    for (const auto& v: objs.MeasuredValueNormalized) {
+        auto it = Positions.find(v.Address);
+        if (it != Positions.end()) {
+            auto& obj = Objects[it->second];
+            obj.ValueType = TValueType::Normalized;
+            obj.FloatValue = v.Value;
+            obj.Quality = v.Quality;
+        }
+    }
+}
+
+size_t IEC104::TCyclicTransmission::Size() const
+{
+    return Objects.size();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "information_object_encoder.h"
+#include "stations.h"
+#include "timer_wheel.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Periodic transmission (COT 1) of measured values without timestamp.
+     *        All cyclic information objects are scheduled in one timer wheel, so a tick touches only objects
+     *        which are due in it, and objects due in the same tick are packed into shared ASDUs.
+     *        Objects are sent with last values passed to Update, objects without values are skipped.
+     *        The class is not threadsafe.
+     */
+    class TCyclicTransmission
+    {
+    public:
+        typedef std::chrono::steady_clock::time_point TTimePoint;
+
+        //! Resolution of cycle periods, Send is expected to be called once per tick
+        static constexpr std::chrono::milliseconds TICK{100};
+
+        TCyclicTransmission(const TCyclePeriods& periods, const TTimePoint& start);
+
+        //! Remember current values of cyclic information objects, other objects are ignored
+        void Update(const TInformationObjects& objs);
+
+        /**
+         * @brief Pack values of information objects which are due at time now into ASDUs with common addresses
+         *        of their stations and pass them to sendFn. Next transmission of the objects is scheduled
+         *        one period later
+         */
+        template<class TSendFn>
+        void Send(CS101_AppLayerParameters appLayerParameters,
+                  const TStations& stations,
+                  const TTimePoint& now,
+                  TSendFn&& sendFn)
+        {
+            Due.MeasuredValueShort.clear();
+            Due.MeasuredValueScaled.clear();
+            Due.MeasuredValueNormalized.clear();
+            Timers.Advance(now, Expired);
+            for (auto id: Expired) {
+                auto& obj = Objects[id];
+                obj.Deadline += obj.Period;
+                if (obj.Deadline <= now) {
+                    // The transmission is late for more than a period, the cycle is restarted
+                    obj.Deadline = now + obj.Period;
+                }
+                Timers.Add(id, obj.Deadline);
+                switch (obj.ValueType) {
+                    case TValueType::Short:
+                        Due.MeasuredValueShort.emplace_back(obj.Address, obj.FloatValue, obj.Quality);
+                        break;
+                    case TValueType::Scaled:
+                        Due.MeasuredValueScaled.emplace_back(obj.Address, obj.IntValue, obj.Quality);
+                        break;
+                    case TValueType::Normalized:
+                        Due.MeasuredValueNormalized.emplace_back(obj.Address, obj.FloatValue, obj.Quality);
+                        break;
+                    case TValueType::None:
+                        break;
+                }
+            }
+            stations.Send(appLayerParameters, CS101_COT_PERIODIC, Due, sendFn);
+        }
+
+        //! Number of cyclic information objects
+        size_t Size() const;
+
+    private:
+        enum class TValueType
+        {
+            None,
+            Short,
+            Scaled,
+            Normalized
+        };
+
+        struct TObject
+        {
+            uint32_t Address;
+            std::chrono::milliseconds Period;
+            TTimePoint Deadline;
+            TValueType ValueType = TValueType::None;
+            union
+            {
+                float FloatValue;
+                int IntValue = 0;
+            };
+            uint8_t Quality = QUALITY_GOOD;
+        };
+
+        std::vector<TObject> Objects;
+        std::unordered_map<uint32_t, size_t> Positions; // Maps information object address to index in Objects
+        TTimerWheel Timers;
+        // Reused between ticks to avoid allocations
+        TInformationObjects Due;
+        std::vector<size_t> Expired;
+    };
+}
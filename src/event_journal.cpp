@@ -0,0 +1,213 @@
+#include "event_journal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "log.h"
+
+#define LOG(logger) ::logger.Log() << "[journal] "
+
+namespace
+{
+    const char MAGIC[8] = "IEC104J";
+    const uint32_t VERSION = 1;
+
+    enum TRecordType : uint8_t
+    {
+        SinglePointWithTimestamp = 1,
+        MeasuredValueShortWithTimestamp = 2,
+        MeasuredValueScaledWithTimestamp = 3
+    };
+
+    int64_t ToMs(const std::chrono::system_clock::time_point& ts)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(ts.time_since_epoch()).count();
+    }
+
+    std::chrono::system_clock::time_point FromMs(int64_t ms)
+    {
+        return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    }
+
+    std::string GetErrorMessage(const std::string& fileName, const std::string& msg)
+    {
+        return "Events journal '" + fileName + "': " + msg + ": " + strerror(errno);
+    }
+}
+
+struct IEC104::TEventJournal::THeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t RecordSize;
+    uint64_t Capacity;
+    uint64_t Head;  // Index of the oldest record
+    uint64_t Count; // Number of stored records
+};
+
+struct IEC104::TEventJournal::TRecord
+{
+    uint32_t Address;
+    uint8_t Type;
+    uint8_t Quality;
+    uint8_t Reserved[2];
+    int64_t TimestampMs;
+    uint32_t Value; // bool as 0/1, float as IEEE 754 bits, int as two's complement
+    uint32_t Reserved2;
+};
+
+IEC104::TEventJournal::TEventJournal(const std::string& fileName, size_t capacity, TJournalOverflowPolicy policy)
+    : Policy(policy),
+      FileSize(sizeof(THeader) + capacity * sizeof(TRecord))
+{
+    if (capacity == 0) {
+        throw std::runtime_error("Events journal '" + fileName + "': capacity must be positive");
+    }
+    Fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (Fd < 0) {
+        throw std::runtime_error(GetErrorMessage(fileName, "can't open"));
+    }
+    if (ftruncate(Fd, FileSize) != 0) {
+        auto msg = GetErrorMessage(fileName, "can't resize");
+        close(Fd);
+        throw std::runtime_error(msg);
+    }
+    auto data = mmap(nullptr, FileSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (data == MAP_FAILED) {
+        auto msg = GetErrorMessage(fileName, "can't map");
+        close(Fd);
+        throw std::runtime_error(msg);
+    }
+    Header = static_cast<THeader*>(data);
+    Records = reinterpret_cast<TRecord*>(static_cast<uint8_t*>(data) + sizeof(THeader));
+
+    if (memcmp(Header->Magic, MAGIC, sizeof(MAGIC)) || Header->Version != VERSION ||
+        Header->RecordSize != sizeof(TRecord) || Header->Capacity != capacity || Header->Head >= capacity ||
+        Header->Count > capacity)
+    {
+        if (memcmp(Header->Magic, MAGIC, sizeof(MAGIC)) == 0) {
+            LOG(Warn) << "'" << fileName << "' has different format or capacity, stored events are dropped";
+        }
+        memcpy(Header->Magic, MAGIC, sizeof(MAGIC));
+        Header->Version = VERSION;
+        Header->RecordSize = sizeof(TRecord);
+        Header->Capacity = capacity;
+        Header->Head = 0;
+        Header->Count = 0;
+    } else if (Header->Count) {
+        LOG(Info) << "'" << fileName << "' contains " << Header->Count << " stored events";
+    }
+}
+
+IEC104::TEventJournal::~TEventJournal()
+{
+    msync(Header, FileSize, MS_SYNC);
+    munmap(Header, FileSize);
+    close(Fd);
+}
+
+bool IEC104::TEventJournal::Append(const TRecord& record)
+{
+    bool dropped = false;
+    if (Header->Count == Header->Capacity) {
+        if (Policy == TJournalOverflowPolicy::DropNewest) {
+            return true;
+        }
+        Header->Head = (Header->Head + 1) % Header->Capacity;
+        --Header->Count;
+        dropped = true;
+    }
+    Records[(Header->Head + Header->Count) % Header->Capacity] = record;
+    ++Header->Count;
+    return dropped;
+}
+
+size_t IEC104::TEventJournal::Append(const TInformationObjects& objs)
+{
+    size_t dropped = 0;
+    TRecord record{};
+    for (const auto& obj: objs.SinglePointWithTimestamp) {
+        record.Address = obj.Address;
+        record.Type = SinglePointWithTimestamp;
+        record.Quality = obj.Quality;
+        record.TimestampMs = ToMs(obj.Timestamp);
+        record.Value = obj.Value ? 1 : 0;
+        dropped += Append(record);
+    }
+    for (const auto& obj: objs.MeasuredValueShortWithTimestamp) {
+        record.Address = obj.Address;
+        record.Type = MeasuredValueShortWithTimestamp;
+        record.Quality = obj.Quality;
+        record.TimestampMs = ToMs(obj.Timestamp);
+        memcpy(&record.Value, &obj.Value, sizeof(record.Value));
+        dropped += Append(record);
+    }
+    for (const auto& obj: objs.MeasuredValueScaledWithTimestamp) {
+        record.Address = obj.Address;
+        record.Type = MeasuredValueScaledWithTimestamp;
+        record.Quality = obj.Quality;
+        record.TimestampMs = ToMs(obj.Timestamp);
+        record.Value = static_cast<uint32_t>(obj.Value);
+        dropped += Append(record);
+    }
+    return dropped;
+}
+
+size_t IEC104::TEventJournal::Peek(size_t maxCount, TInformationObjects& res) const
+{
+    size_t i = 0;
+    for (; i < std::min<size_t>(maxCount, Header->Count); ++i) {
+        const auto& record = Records[(Header->Head + i) % Header->Capacity];
+        if (record.Type != Records[Header->Head].Type) {
+            break;
+        }
+        switch (record.Type) {
+            case SinglePointWithTimestamp:
+                res.SinglePointWithTimestamp.emplace_back(record.Address,
+                                                          FromMs(record.TimestampMs),
+                                                          record.Value != 0,
+                                                          record.Quality);
+                break;
+            case MeasuredValueShortWithTimestamp: {
+                float value;
+                memcpy(&value, &record.Value, sizeof(value));
+                res.MeasuredValueShortWithTimestamp.emplace_back(record.Address,
+                                                                 FromMs(record.TimestampMs),
+                                                                 value,
+                                                                 record.Quality);
+                break;
+            }
+            case MeasuredValueScaledWithTimestamp:
+                res.MeasuredValueScaledWithTimestamp.emplace_back(record.Address,
+                                                                  FromMs(record.TimestampMs),
+                                                                  static_cast<int32_t>(record.Value),
+                                                                  record.Quality);
+                break;
+            default:
+                // Damaged record, skip it
+                break;
+        }
+    }
+    return i;
+}
+
+void IEC104::TEventJournal::Pop(size_t count)
+{
+    count = std::min<size_t>(count, Header->Count);
+    Header->Head = (Header->Head + count) % Header->Capacity;
+    Header->Count -= count;
+}
+
+size_t IEC104::TEventJournal::Size() const
+{
+    return Header->Count;
+}
+
+bool IEC104::TEventJournal::IsEmpty() const
+{
+    return Header->Count == 0;
+}
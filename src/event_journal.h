@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+
+#include "IEC104Server.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Persistent ring buffer of information objects with timestamp.
+     *        Records have fixed size and are stored in memory mapped file, so the journal survives restarts
+     *        and its memory usage is bounded by capacity.
+     *        Information objects without timestamp are ignored.
+     *        The class is not threadsafe.
+     */
+    class TEventJournal
+    {
+    public:
+        /**
+         * @brief Open or create journal file. Existing journal with different capacity or format is cleared.
+         *        Throws std::runtime_error if the file can't be opened or mapped.
+         */
+        TEventJournal(const std::string& fileName, size_t capacity, TJournalOverflowPolicy policy);
+        ~TEventJournal();
+
+        TEventJournal(const TEventJournal&) = delete;
+        TEventJournal& operator=(const TEventJournal&) = delete;
+
+        //! Append information objects with timestamp. Returns number of dropped records
+        size_t Append(const TInformationObjects& objs);
+
+        /**
+         * @brief Get oldest records of the same type, not more than maxCount.
+         *        Records are not removed from the journal.
+         *
+         * @return number of read records
+         */
+        size_t Peek(size_t maxCount, TInformationObjects& objs) const;
+
+        //! Remove count oldest records
+        void Pop(size_t count);
+
+        size_t Size() const;
+
+        bool IsEmpty() const;
+
+    private:
+        struct THeader;
+        struct TRecord;
+
+        TJournalOverflowPolicy Policy;
+        int Fd;
+        size_t FileSize;
+        THeader* Header;
+        TRecord* Records;
+
+        bool Append(const TRecord& record);
+    };
+}
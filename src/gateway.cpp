@@ -1,6 +1,14 @@
 #include "gateway.h"
 
 #include "log.h"
+#include "point_index.h"
+#include "statistics.h"
+#include "timer_wheel.h"
+#include "value_parser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 using namespace WBMQTT;
@@ -9,178 +17,963 @@ using namespace WBMQTT;
 
 namespace
 {
-    bool Append(IEC104::TInformationObjects& objs,
-                PControl control,
-                const std::string& v,
-                const TIecInformationObject& obj) noexcept
+    const auto ERROR_TOPIC = "/devices/+/controls/+/meta/error";
+
+    const auto STALE_CHECK_INTERVAL = std::chrono::seconds(1);
+    const size_t STALE_TIMER_BUCKETS = 64;
+
+    const auto SEND_TIMER_TICK = std::chrono::milliseconds(100);
+    const size_t SEND_TIMER_BUCKETS = 64;
+
+    // Retained values of all controls come in a burst on startup, the queue smooths it
+    const size_t CHANGES_QUEUE_SIZE = 16384;
+    const size_t CONVERSION_BATCH_SIZE = 256;
+
+    const auto CONVERSION_ERRORS_LOG_INTERVAL = std::chrono::seconds(10);
+
+    /**
+     * @brief Logs the first conversion error of an interval, following errors are only counted
+     *        and their number is logged with the first error of next interval
+     */
+    class TConversionErrorLog
     {
-        if (v.empty()) {
-            return false;
+        std::mutex Mutex;
+        std::chrono::steady_clock::time_point IntervalStart;
+        size_t Suppressed = 0;
+
+    public:
+        void Log(const TControlDesc& control, const std::string& value, TParseResult result)
+        {
+            Statistics.ConversionErrors.Add();
+            auto now = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lk(Mutex);
+            if (IntervalStart != std::chrono::steady_clock::time_point() &&
+                now - IntervalStart < CONVERSION_ERRORS_LOG_INTERVAL)
+            {
+                ++Suppressed;
+                return;
+            }
+            IntervalStart = now;
+            auto suppressed = Suppressed;
+            Suppressed = 0;
+            lk.unlock();
+            if (suppressed) {
+                LOG(Warn) << suppressed << " more MQTT values were not convertible since last warning";
+            }
+            LOG(Warn) << "'" << control.Device << "'/'" << control.Control << "' = '" << value
+                      << "' is not convertible to IEC 608760-5-104 information object: "
+                      << ValueParser::GetDescription(result);
         }
+    };
 
-        auto now = std::chrono::system_clock::now();
+    TConversionErrorLog ConversionErrorLog;
 
-        try {
-            switch (obj.Type) {
-                case SinglePoint: {
-                    if (v == "0") {
-                        objs.SinglePoint.emplace_back(obj.Address, false);
-                        return true;
-                    }
-                    if (v == "1") {
-                        objs.SinglePoint.emplace_back(obj.Address, true);
-                        return true;
-                    }
-                    throw std::runtime_error(v + " is not convertible to bool");
-                }
-                case MeasuredValueShort: {
-                    objs.MeasuredValueShort.emplace_back(obj.Address, stof(v));
-                    return true;
+    bool Convert(TIecInformationObjectValue& res, const TControlDesc& control, const std::string& v) noexcept
+    {
+        TParseResult result = TParseResult::Invalid;
+        switch (res.Object.Type) {
+            case SinglePoint:
+            case SinglePointWithTimestamp: {
+                result = ValueParser::ParseBool(v, res.BoolValue);
+                break;
+            }
+            case MeasuredValueShort:
+            case MeasuredValueShortWithTimestamp: {
+                result = ValueParser::ParseFloat(v, res.FloatValue);
+                break;
+            }
+            case MeasuredValueScaled:
+            case MeasuredValueScaledWithTimestamp: {
+                int32_t value;
+                result = ValueParser::ParseInt(v, value);
+                if (result == TParseResult::Ok) {
+                    res.IntValue = value;
                 }
-                case MeasuredValueScaled: {
-                    objs.MeasuredValueScaled.emplace_back(obj.Address, stoi(v));
-                    return true;
+                break;
+            }
+            case DoublePoint: {
+                // MQTT switch values 0/1 are mapped to off/on, intermediate and faulty states follow them
+                static const uint8_t DOUBLE_POINT_VALUES[] = {IEC104::DOUBLE_POINT_OFF,
+                                                              IEC104::DOUBLE_POINT_ON,
+                                                              IEC104::DOUBLE_POINT_INTERMEDIATE,
+                                                              IEC104::DOUBLE_POINT_INDETERMINATE};
+                int32_t value;
+                result = ValueParser::ParseInt(v, value);
+                if (result == TParseResult::Ok) {
+                    if (value < 0 || value > 3) {
+                        result = TParseResult::OutOfRange;
+                        break;
+                    }
+                    res.IntValue = DOUBLE_POINT_VALUES[value];
                 }
-                case SinglePointWithTimestamp: {
-                    if (v == "0") {
-                        objs.SinglePointWithTimestamp.emplace_back(obj.Address, now, false);
-                        return true;
+                break;
+            }
+            case MeasuredValueNormalized: {
+                float value;
+                result = ValueParser::ParseFloat(v, value);
+                if (result == TParseResult::Ok) {
+                    if (value < -1 || value > 1) {
+                        result = TParseResult::OutOfRange;
+                        break;
                     }
-                    if (v == "1") {
-                        objs.SinglePointWithTimestamp.emplace_back(obj.Address, now, true);
-                        return true;
+                    res.FloatValue = value;
+                }
+                break;
+            }
+            case BitString: {
+                double value;
+                result = ValueParser::ParseDouble(v, value);
+                if (result == TParseResult::Ok) {
+                    if (value < 0 || value > std::numeric_limits<uint32_t>::max()) {
+                        result = TParseResult::OutOfRange;
+                        break;
                     }
-                    throw std::runtime_error(v + " is not convertible to bool");
+                    res.IntValue = static_cast<int32_t>(static_cast<uint32_t>(value));
                 }
-                case MeasuredValueShortWithTimestamp: {
-                    objs.MeasuredValueShortWithTimestamp.emplace_back(obj.Address, now, stof(v));
-                    return true;
+                break;
+            }
+            case StepPosition: {
+                int32_t value;
+                result = ValueParser::ParseInt(v, value);
+                if (result == TParseResult::Ok) {
+                    if (value < IEC104::STEP_POSITION_MIN || value > IEC104::STEP_POSITION_MAX) {
+                        result = TParseResult::OutOfRange;
+                        break;
+                    }
+                    res.IntValue = value;
                 }
-                case MeasuredValueScaledWithTimestamp: {
-                    objs.MeasuredValueScaledWithTimestamp.emplace_back(obj.Address, now, stoi(v));
-                    return true;
+                break;
+            }
+            case IntegratedTotals:
+            case IntegratedTotalsWithTimestamp: {
+                double value;
+                result = ValueParser::ParseDouble(v, value);
+                if (result == TParseResult::Ok) {
+                    value = std::round(value * res.Object.CounterScale);
+                    if (!std::isfinite(value) || std::fabs(value) >= std::numeric_limits<int64_t>::max()) {
+                        result = TParseResult::OutOfRange;
+                        break;
+                    }
+                    // Binary counter reading is 32-bit, bigger values roll over
+                    res.IntValue = static_cast<int32_t>(static_cast<uint32_t>(static_cast<int64_t>(value)));
                 }
+                break;
             }
-        } catch (const std::exception& e) {
-            LOG(Warn) << "'" << control->GetDevice()->GetId() << "'/'" << control->GetId() << "' = '" << v
-                      << "' is not convertible to IEC 608760-5-104 information object: " << e.what();
+        }
+        if (result == TParseResult::Ok) {
+            res.HasValue = true;
+            return true;
+        }
+        if (result != TParseResult::Empty) {
+            ConversionErrorLog.Log(control, v, result);
         }
         return false;
     }
 
+    //! Read error makes value invalid, missed poll period makes it not topical. Write error doesn't affect value
+    uint8_t GetErrorQuality(const std::string& error)
+    {
+        uint8_t quality = IEC104::QUALITY_GOOD;
+        if (error.find('r') != std::string::npos) {
+            quality |= IEC104::QUALITY_INVALID;
+        }
+        if (error.find('p') != std::string::npos) {
+            quality |= IEC104::QUALITY_NON_TOPICAL;
+        }
+        return quality;
+    }
+
+    uint8_t GetQuality(const TIecInformationObjectValue& v)
+    {
+        if (!v.HasValue) {
+            return v.ErrorQuality | IEC104::QUALITY_INVALID;
+        }
+        return v.ErrorQuality | (v.IsStale ? IEC104::QUALITY_NON_TOPICAL : IEC104::QUALITY_GOOD);
+    }
+
+    //! Get device and control names from /devices/<device>/controls/<control>/meta/error topic
+    bool ParseErrorTopic(const std::string& topic, std::string& device, std::string& control)
+    {
+        const std::string prefix = "/devices/";
+        const std::string infix = "/controls/";
+        const std::string suffix = "/meta/error";
+        if (topic.size() < prefix.size() + infix.size() + suffix.size() || topic.compare(0, prefix.size(), prefix) ||
+            topic.compare(topic.size() - suffix.size(), suffix.size(), suffix))
+        {
+            return false;
+        }
+        auto controlEnd = topic.size() - suffix.size();
+        auto pos = topic.find(infix, prefix.size());
+        if (pos == std::string::npos || pos + infix.size() > controlEnd) {
+            return false;
+        }
+        device = topic.substr(prefix.size(), pos - prefix.size());
+        control = topic.substr(pos + infix.size(), controlEnd - pos - infix.size());
+        return true;
+    }
+
+    void Append(IEC104::TInformationObjects& objs, const TIecInformationObjectValue& v)
+    {
+        auto quality = GetQuality(v);
+        switch (v.Object.Type) {
+            case SinglePoint:
+                objs.SinglePoint.emplace_back(v.Object.Address, v.BoolValue, quality);
+                break;
+            case MeasuredValueShort:
+                objs.MeasuredValueShort.emplace_back(v.Object.Address, v.FloatValue, quality);
+                break;
+            case MeasuredValueScaled:
+                objs.MeasuredValueScaled.emplace_back(v.Object.Address, v.IntValue, quality);
+                break;
+            case SinglePointWithTimestamp:
+                objs.SinglePointWithTimestamp.emplace_back(v.Object.Address, v.Timestamp, v.BoolValue, quality);
+                break;
+            case MeasuredValueShortWithTimestamp:
+                objs.MeasuredValueShortWithTimestamp.emplace_back(v.Object.Address,
+                                                                  v.Timestamp,
+                                                                  v.FloatValue,
+                                                                  quality);
+                break;
+            case MeasuredValueScaledWithTimestamp:
+                objs.MeasuredValueScaledWithTimestamp.emplace_back(v.Object.Address,
+                                                                   v.Timestamp,
+                                                                   v.IntValue,
+                                                                   quality);
+                break;
+            case IntegratedTotals:
+                objs.IntegratedTotals.emplace_back(v.Object.Address, v.IntValue, false, quality);
+                break;
+            case IntegratedTotalsWithTimestamp:
+                objs.IntegratedTotals.emplace_back(v.Object.Address, v.IntValue, true, quality);
+                break;
+            case DoublePoint:
+                objs.DoublePoint.emplace_back(v.Object.Address, v.IntValue, quality);
+                break;
+            case MeasuredValueNormalized:
+                objs.MeasuredValueNormalized.emplace_back(v.Object.Address, v.FloatValue, quality);
+                break;
+            case BitString:
+                objs.BitString.emplace_back(v.Object.Address, static_cast<uint32_t>(v.IntValue), quality);
+                break;
+            case StepPosition:
+                objs.StepPosition.emplace_back(v.Object.Address, v.IntValue, quality);
+                break;
+        }
+    }
+
+    bool IsMeasuredValue(const TIecInformationObject& obj)
+    {
+        return (obj.Type == MeasuredValueShort || obj.Type == MeasuredValueShortWithTimestamp ||
+                obj.Type == MeasuredValueScaled || obj.Type == MeasuredValueScaledWithTimestamp ||
+                obj.Type == MeasuredValueNormalized);
+    }
+
+    double GetMeasuredValue(const TIecInformationObjectValue& v)
+    {
+        if (v.Object.Type == MeasuredValueShort || v.Object.Type == MeasuredValueShortWithTimestamp ||
+            v.Object.Type == MeasuredValueNormalized)
+        {
+            return v.FloatValue;
+        }
+        return v.IntValue;
+    }
+
+    //! Measured value differs from last sent one not more than by its deadbands
+    bool IsInDeadband(const TIecInformationObjectValue& v)
+    {
+        auto diff = std::fabs(GetMeasuredValue(v) - v.SentValue);
+        return (v.Object.Deadband > 0 && diff <= v.Object.Deadband) ||
+               (v.Object.DeadbandPercent > 0 && diff <= std::fabs(v.SentValue) * v.Object.DeadbandPercent / 100);
+    }
+
+    /**
+     * @brief Check deadbands and send interval of measured value and remember it as sent if it passes
+     *
+     * @param force the value is sent regardless of deadbands and send interval
+     */
+    bool ShouldSend(TIecInformationObjectValue& v, const std::chrono::steady_clock::time_point& now, bool force)
+    {
+        if (!IsMeasuredValue(v.Object)) {
+            return true;
+        }
+        if (!force) {
+            if (IsInDeadband(v)) {
+                return false;
+            }
+            if (v.SentTime != std::chrono::steady_clock::time_point() && now - v.SentTime < v.Object.SendInterval) {
+                return false;
+            }
+        }
+        v.SentValue = GetMeasuredValue(v);
+        v.SentTime = now;
+        return true;
+    }
+
+    //! Convert MQTT value of a control to values of information objects in slots [firstSlot, lastSlot) of the index
+    void Convert(std::vector<std::pair<size_t, TIecInformationObjectValue>>& res,
+                 const TPointIndex& index,
+                 size_t firstSlot,
+                 size_t lastSlot,
+                 const TValueChange& change)
+    {
+        for (auto slot = firstSlot; slot != lastSlot; ++slot) {
+            TIecInformationObjectValue value(index.GetObject(slot));
+            if (Convert(value, index.GetControl(slot), change.RawValue)) {
+                value.Timestamp = change.Time;
+                value.UpdateTime = change.SteadyTime;
+                res.emplace_back(slot, value);
+            }
+        }
+    }
+
+    std::vector<std::string> GetDeviceIds(const TDeviceConfig& devices)
+    {
+        std::vector<std::string> deviceIds;
+        for (const auto& device: devices) {
+            deviceIds.emplace_back(device.first);
+        }
+        return deviceIds;
+    }
+
+    bool HasStaleTimeouts(const std::vector<TIecInformationObjectValue>& values)
+    {
+        return std::any_of(values.begin(), values.end(), [](const auto& v) { return v.Object.StaleTimeout.count(); });
+    }
+
+    bool HasSendIntervals(const std::vector<TIecInformationObjectValue>& values)
+    {
+        return std::any_of(values.begin(), values.end(), [](const auto& v) { return v.Object.SendInterval.count(); });
+    }
+
     std::string GetFullName(PControl control)
     {
         return "'" + control->GetDevice()->GetId() + "'/'" + control->GetId() + "'";
     }
 }
 
-TGateway::TGateway(PDeviceDriver driver, IEC104::IServer* iecServer, const TDeviceConfig& devices)
+TGateway::TGateway(PDeviceDriver driver,
+                   IEC104::IServer* iecServer,
+                   const TDeviceConfig& devices,
+                   PMqttClient mqttClient)
     : Driver(driver),
-      Devices(devices),
-      IecServer(iecServer)
+      IecServer(iecServer),
+      Index(std::make_shared<const TPointIndex>(devices)),
+      MqttClient(mqttClient),
+      Changes(CHANGES_QUEUE_SIZE)
 {
-    std::vector<std::string> deviceIds;
-    for (const auto& device: devices) {
-        LOG(Debug) << "'" << device.first << "' is added to filter";
-        deviceIds.emplace_back(device.first);
+    // Values which are not received yet are sent as invalid
+    auto now = std::chrono::system_clock::now();
+    Values.reserve(Index->Size());
+    for (size_t slot = 0; slot < Index->Size(); ++slot) {
+        Values.emplace_back(Index->GetObject(slot));
+        Values.back().Timestamp = now;
     }
-    Driver->SetFilter(GetDeviceListFilter(deviceIds));
-    Driver->WaitForReady();
-
-    for (const auto& device: devices) {
-        for (const auto& control: device.second) {
-            IoaToControls[control.second.Address] = {device.first, control.first};
-        }
+    if (HasStaleTimeouts(Values)) {
+        StaleTimers.reset(
+            new TTimerWheel(STALE_TIMER_BUCKETS, STALE_CHECK_INTERVAL, std::chrono::steady_clock::now()));
+    }
+    if (HasSendIntervals(Values)) {
+        SendTimers.reset(new TTimerWheel(SEND_TIMER_BUCKETS, SEND_TIMER_TICK, std::chrono::steady_clock::now()));
     }
 
-    Driver->On<TControlValueEvent>([this](const WBMQTT::TControlValueEvent& event) { OnValueChanged(event); });
+    ConversionThread = std::thread([this]() {
+        SetThreadName("iec104 convert");
+        ConversionLoop();
+    });
+    // IEC server accepts connections from now on, the cache is filled while retained values are coming
     iecServer->SetHandler(this);
+    Driver->On<TControlValueEvent>([this](const WBMQTT::TControlValueEvent& event) { OnValueChanged(event); });
+    if (MqttClient) {
+        MqttClient->Subscribe([this](const WBMQTT::TMqttMessage& message) { OnErrorChanged(message); }, ERROR_TOPIC);
+    }
+
+    DeviceIds = GetDeviceIds(devices);
+    for (const auto& device: DeviceIds) {
+        LOG(Debug) << "'" << device << "' is added to filter";
+    }
+    Driver->SetFilter(GetDeviceListFilter(DeviceIds));
+    Driver->WaitForReady();
+    LoadValues();
+    StartStaleLoop();
+    StartSendLoop();
+}
+
+TGateway::~TGateway()
+{
+    StopSendLoop();
+    StopStaleLoop();
+    StopConversionLoop();
 }
 
 void TGateway::Stop()
 {
+    if (MqttClient) {
+        MqttClient->Unsubscribe(ERROR_TOPIC);
+    }
+    StopSendLoop();
+    StopStaleLoop();
+    StopConversionLoop();
     IecServer->Stop();
     Driver->StopLoop();
 }
 
 void TGateway::OnValueChanged(const WBMQTT::TControlValueEvent& event)
 {
-    auto itDevice = Devices.find(event.Control->GetDevice()->GetId());
-    if (itDevice == Devices.end()) {
-        LOG(Debug) << "Got message from " << GetFullName(event.Control) << ". No config for device";
+    auto index = std::atomic_load(&Index);
+    auto slots = index->Find(event.Control->GetDevice()->GetId(), event.Control->GetId());
+    if (slots.IsEmpty()) {
+        LOG(Debug) << "Got message from " << GetFullName(event.Control) << ". No config for control";
         return;
     }
+    Statistics.MqttChanges.Add();
 
-    auto itControl = itDevice->second.equal_range(event.Control->GetId());
-    if (itControl.first == itDevice->second.end()) {
-        LOG(Debug) << "Got message from " << GetFullName(event.Control) << ". No config for control";
+    // Reception time is the time of change for all information objects of the control. meta/ts of the control
+    // isn't used, it comes in a separate message which MQTT doesn't order with the value
+    TValueChange change{std::move(index),
+                        slots.First,
+                        slots.Last,
+                        event.RawValue,
+                        std::chrono::system_clock::now(),
+                        std::chrono::steady_clock::now()};
+    while (!Changes.TryPush(std::move(change))) {
+        // Conversion thread is far behind, slow down MQTT instead of losing changes
+        if (StopConversionThread) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+    ++PushedChanges;
+    if (ConversionThreadIsWaiting) {
+        std::unique_lock<std::mutex> lk(ChangesMutex);
+        ChangesCv.notify_one();
+    }
+}
+
+void TGateway::ConversionLoop()
+{
+    std::vector<TValueChange> batch;
+    batch.reserve(CONVERSION_BATCH_SIZE);
+    TValueChange change;
+    for (;;) {
+        while (batch.size() < CONVERSION_BATCH_SIZE && Changes.TryPop(change)) {
+            batch.push_back(std::move(change));
+        }
+        if (!batch.empty()) {
+            ProcessChanges(batch);
+            std::unique_lock<std::mutex> lk(ChangesMutex);
+            ProcessedChanges += batch.size();
+            batch.clear();
+            ProcessedCv.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(ChangesMutex);
+        // The flag is set before checking of PushedChanges, so a producer either sees it or its change is seen here
+        ConversionThreadIsWaiting = true;
+        ChangesCv.wait(lk, [this]() { return StopConversionThread || PushedChanges != ProcessedChanges; });
+        ConversionThreadIsWaiting = false;
+        if (StopConversionThread) {
+            break;
+        }
+    }
+}
+
+void TGateway::ProcessChanges(const std::vector<TValueChange>& changes)
+{
+    ConvertedValues.clear();
+    for (const auto& change: changes) {
+        Convert(ConvertedValues, *change.Index, change.FirstSlot, change.LastSlot, change);
+    }
+
+    bool hasObjs = false;
+    bool hasFilteredObjs = false;
+    IEC104::TInformationObjects objs;
+    IEC104::TInformationObjects filteredObjs;
+    std::unique_lock<std::mutex> lk(ValuesMutex);
+    if (std::any_of(changes.begin(), changes.end(), [this](const auto& c) { return c.Index != Index; })) {
+        // Configuration has been reloaded since the changes were queued, so slots are looked up again
+        ConvertedValues.clear();
+        for (const auto& change: changes) {
+            const auto& desc = change.Index->GetControl(change.FirstSlot);
+            auto slots = Index->Find(desc.Device, desc.Control);
+            Convert(ConvertedValues, *Index, slots.First, slots.Last, change);
+        }
+    }
+    for (auto& converted: ConvertedValues) {
+        auto slot = converted.first;
+        auto& value = converted.second;
+        auto& cachedValue = Values[slot];
+        value.SentValue = cachedValue.SentValue;
+        value.SentTime = cachedValue.SentTime;
+        value.ErrorQuality = cachedValue.ErrorQuality;
+        value.HasStaleTimer = cachedValue.HasStaleTimer;
+        value.HasSendTimer = cachedValue.HasSendTimer;
+        // Refreshed or first received value becomes topical and valid,
+        // the change of quality is sent regardless of deadbands
+        bool send = ShouldSend(value, value.UpdateTime, cachedValue.IsStale || !cachedValue.HasValue);
+        // Change within deadbands is not sent later either, so it cancels a held back one
+        value.IsSendDelayed = !send && IsMeasuredValue(value.Object) && !IsInDeadband(value);
+        cachedValue = value;
+        SetStaleTimer(slot);
+        SetSendTimer(slot);
+        if (send) {
+            Append(objs, value);
+            hasObjs = true;
+        } else {
+            Append(filteredObjs, value);
+            hasFilteredObjs = true;
+            Statistics.FilteredChanges.Add();
+        }
+    }
+    if (hasObjs) {
+        IecServer->SendSpontaneous(objs);
+    }
+    if (hasFilteredObjs) {
+        IecServer->UpdateValues(filteredObjs);
+    }
+}
+
+void TGateway::WaitForChanges()
+{
+    uint64_t pushed = PushedChanges;
+    std::unique_lock<std::mutex> lk(ChangesMutex);
+    ProcessedCv.wait(lk, [&]() { return ProcessedChanges >= pushed || StopConversionThread; });
+}
+
+void TGateway::StopConversionLoop()
+{
+    {
+        std::unique_lock<std::mutex> lk(ChangesMutex);
+        StopConversionThread = true;
+    }
+    ChangesCv.notify_all();
+    ProcessedCv.notify_all();
+    if (ConversionThread.joinable()) {
+        ConversionThread.join();
+    }
+}
+
+void TGateway::OnErrorChanged(const WBMQTT::TMqttMessage& message)
+{
+    std::string device;
+    std::string control;
+    if (!ParseErrorTopic(message.Topic, device, control)) {
         return;
     }
 
+    auto quality = GetErrorQuality(message.Payload);
+    auto now = std::chrono::system_clock::now();
     bool hasObjs = false;
     IEC104::TInformationObjects objs;
-    while (itControl.first != itControl.second) {
-        hasObjs |= Append(objs, event.Control, event.RawValue, itControl.first->second);
-        ++itControl.first;
+    std::unique_lock<std::mutex> lk(ValuesMutex);
+    auto slots = Index->Find(device, control);
+    for (auto slot = slots.First; slot != slots.Last; ++slot) {
+        auto& value = Values[slot];
+        if (value.ErrorQuality == quality) {
+            continue;
+        }
+        auto oldQuality = GetQuality(value);
+        value.ErrorQuality = quality;
+        if (value.HasValue && GetQuality(value) != oldQuality) {
+            value.Timestamp = now;
+            Append(objs, value);
+            hasObjs = true;
+        }
     }
     if (hasObjs) {
+        LOG(Debug) << "'" << device << "'/'" << control << "' error is '" << message.Payload << "'";
         IecServer->SendSpontaneous(objs);
     }
 }
 
-IEC104::TInformationObjects TGateway::GetInformationObjectsValues() const noexcept
+void TGateway::SetStaleTimer(size_t slot)
+{
+    auto& value = Values[slot];
+    if (StaleTimers && !value.HasStaleTimer && value.Object.StaleTimeout.count()) {
+        StaleTimers->Add(slot, value.UpdateTime + value.Object.StaleTimeout);
+        value.HasStaleTimer = true;
+    }
+}
+
+void TGateway::StaleLoop()
+{
+    std::vector<size_t> expired; // Reused between checks
+    std::unique_lock<std::mutex> lk(ValuesMutex);
+    while (!StaleCv.wait_for(lk, STALE_CHECK_INTERVAL, [this]() { return StopStaleThread; })) {
+        auto steadyNow = std::chrono::steady_clock::now();
+        auto now = std::chrono::system_clock::now();
+        bool hasObjs = false;
+        IEC104::TInformationObjects objs;
+        StaleTimers->Advance(steadyNow, expired);
+        for (auto slot: expired) {
+            auto& value = Values[slot];
+            value.HasStaleTimer = false;
+            if (value.UpdateTime + value.Object.StaleTimeout > steadyNow) {
+                // The value has been refreshed since the timer was set
+                SetStaleTimer(slot);
+                continue;
+            }
+            if (!value.IsStale) {
+                auto oldQuality = GetQuality(value);
+                value.IsStale = true;
+                if (GetQuality(value) != oldQuality) {
+                    value.Timestamp = now;
+                    Append(objs, value);
+                    hasObjs = true;
+                }
+            }
+        }
+        if (hasObjs) {
+            IecServer->SendSpontaneous(objs);
+        }
+    }
+}
+
+void TGateway::StartStaleLoop()
 {
+    if (StaleTimers && !StaleThread.joinable()) {
+        StaleThread = std::thread([this]() {
+            SetThreadName("iec104 stale");
+            StaleLoop();
+        });
+    }
+}
+
+void TGateway::StopStaleLoop()
+{
+    {
+        std::unique_lock<std::mutex> lk(ValuesMutex);
+        StopStaleThread = true;
+    }
+    StaleCv.notify_all();
+    if (StaleThread.joinable()) {
+        StaleThread.join();
+    }
+}
+
+void TGateway::SetSendTimer(size_t slot)
+{
+    auto& value = Values[slot];
+    if (SendTimers && !value.HasSendTimer && value.IsSendDelayed) {
+        SendTimers->Add(slot, value.SentTime + value.Object.SendInterval);
+        value.HasSendTimer = true;
+    }
+}
+
+void TGateway::SendLoop()
+{
+    std::vector<size_t> expired; // Reused between checks
+    std::unique_lock<std::mutex> lk(ValuesMutex);
+    while (!SendCv.wait_for(lk, SEND_TIMER_TICK, [this]() { return StopSendThread; })) {
+        auto steadyNow = std::chrono::steady_clock::now();
+        bool hasObjs = false;
+        IEC104::TInformationObjects objs;
+        SendTimers->Advance(steadyNow, expired);
+        for (auto slot: expired) {
+            auto& value = Values[slot];
+            value.HasSendTimer = false;
+            if (!value.IsSendDelayed) {
+                continue;
+            }
+            if (value.SentTime + value.Object.SendInterval > steadyNow) {
+                // The value has been sent since the timer was set, for example on quality change
+                SetSendTimer(slot);
+                continue;
+            }
+            ShouldSend(value, steadyNow, true);
+            value.IsSendDelayed = false;
+            Append(objs, value);
+            hasObjs = true;
+        }
+        if (hasObjs) {
+            IecServer->SendSpontaneous(objs);
+        }
+    }
+}
+
+void TGateway::StartSendLoop()
+{
+    if (SendTimers && !SendThread.joinable()) {
+        SendThread = std::thread([this]() {
+            SetThreadName("iec104 send");
+            SendLoop();
+        });
+    }
+}
+
+void TGateway::StopSendLoop()
+{
+    {
+        std::unique_lock<std::mutex> lk(ValuesMutex);
+        StopSendThread = true;
+    }
+    SendCv.notify_all();
+    if (SendThread.joinable()) {
+        SendThread.join();
+    }
+}
+
+void TGateway::LoadValues()
+{
+    bool hasObjs = false;
     IEC104::TInformationObjects objs;
+    std::unique_lock<std::mutex> lk(ValuesMutex, std::defer_lock);
     try {
+        auto now = std::chrono::system_clock::now();
+        auto steadyNow = std::chrono::steady_clock::now();
         auto tx = Driver->BeginTx();
-        for (const auto& device: Devices) {
-            auto pDevice = tx->GetDevice(device.first);
-            if (pDevice) {
-                for (const auto& control: device.second) {
-                    auto pControl = pDevice->GetControl(control.first);
-                    if (pControl) {
-                        Append(objs, pControl, pControl->GetRawValue(), control.second);
-                    }
+        lk.lock();
+        PDevice pDevice;
+        PControl pControl;
+        for (size_t slot = 0; slot < Values.size(); ++slot) {
+            // Values received during synchronization with MQTT are already sent
+            if (Values[slot].HasValue) {
+                continue;
+            }
+            const auto& desc = Index->GetControl(slot);
+            if (!pDevice || pDevice->GetId() != desc.Device) {
+                pDevice = tx->GetDevice(desc.Device);
+                pControl.reset();
+            }
+            if (!pDevice) {
+                continue;
+            }
+            if (!pControl || pControl->GetId() != desc.Control) {
+                pControl = pDevice->GetControl(desc.Control);
+            }
+            if (pControl) {
+                auto& value = Values[slot];
+                value.ErrorQuality = GetErrorQuality(pControl->GetError());
+                if (Convert(value, desc, pControl->GetRawValue())) {
+                    value.Timestamp = now;
+                    value.UpdateTime = steadyNow;
+                    SetStaleTimer(slot);
+                    // Masters activated before the value is loaded have got it as invalid,
+                    // so it is sent spontaneously regardless of deadbands and send interval
+                    ShouldSend(value, steadyNow, true);
+                    Append(objs, value);
+                    hasObjs = true;
                 }
             }
         }
     } catch (const std::exception& e) {
-        LOG(Warn) << "TGateway::GetInformationObjectsValues() error: " << e.what();
+        LOG(Warn) << "TGateway::LoadValues() error: " << e.what();
+    }
+    if (!lk.owns_lock()) {
+        lk.lock();
+    }
+    if (hasObjs) {
+        IecServer->SendSpontaneous(objs);
+    }
+}
+
+void TGateway::Reload(const TDeviceConfig& devices, const IEC104::TServerConfig& iecConfig)
+{
+    auto index = std::make_shared<const TPointIndex>(devices);
+    auto now = std::chrono::system_clock::now();
+    size_t addedCount = 0;
+    size_t removedCount = 0;
+    {
+        std::unique_lock<std::mutex> lk(ValuesMutex);
+        // Values of information objects with the same control, address and type are kept
+        std::vector<TIecInformationObjectValue> values;
+        values.reserve(index->Size());
+        std::vector<bool> isKept(Values.size(), false);
+        for (size_t slot = 0; slot < index->Size(); ++slot) {
+            const auto& object = index->GetObject(slot);
+            const auto& desc = index->GetControl(slot);
+            auto oldSlots = Index->Find(desc.Device, desc.Control);
+            auto oldSlot = oldSlots.First;
+            while (oldSlot != oldSlots.Last &&
+                   (Values[oldSlot].Object.Address != object.Address || Values[oldSlot].Object.Type != object.Type))
+            {
+                ++oldSlot;
+            }
+            if (oldSlot != oldSlots.Last) {
+                isKept[oldSlot] = true;
+                values.push_back(Values[oldSlot]);
+                values.back().Object = object;
+                values.back().HasStaleTimer = false;
+                values.back().HasSendTimer = false;
+            } else {
+                values.emplace_back(object);
+                values.back().Timestamp = now;
+                ++addedCount;
+            }
+        }
+
+        // IEC 60870-5-104 has no means to delete an information object, so masters get removed ones as invalid
+        IEC104::TInformationObjects removedObjs;
+        for (size_t slot = 0; slot < Values.size(); ++slot) {
+            if (!isKept[slot]) {
+                auto& value = Values[slot];
+                value.HasValue = false;
+                value.Timestamp = now;
+                Append(removedObjs, value);
+                ++removedCount;
+            }
+        }
+        if (removedCount) {
+            IecServer->SendSpontaneous(removedObjs);
+        }
+
+        Values.swap(values);
+        std::atomic_store(&Index, std::shared_ptr<const TPointIndex>(index));
+        if (StaleTimers || HasStaleTimeouts(Values)) {
+            StaleTimers.reset(
+                new TTimerWheel(STALE_TIMER_BUCKETS, STALE_CHECK_INTERVAL, std::chrono::steady_clock::now()));
+            for (size_t slot = 0; slot < Values.size(); ++slot) {
+                if (Values[slot].HasValue && !Values[slot].IsStale) {
+                    SetStaleTimer(slot);
+                }
+            }
+        }
+        if (SendTimers || HasSendIntervals(Values)) {
+            SendTimers.reset(new TTimerWheel(SEND_TIMER_BUCKETS, SEND_TIMER_TICK, std::chrono::steady_clock::now()));
+            for (size_t slot = 0; slot < Values.size(); ++slot) {
+                SetSendTimer(slot);
+            }
+        }
+
+        // Values are passed to IEC server under ValuesMutex, so changes of removed objects can't follow this
+        IEC104::TInformationObjects objs;
+        for (const auto& value: Values) {
+            Append(objs, value);
+        }
+        IecServer->Reconfigure(iecConfig, objs);
+    }
+    StartStaleLoop();
+    StartSendLoop();
+
+    auto deviceIds = GetDeviceIds(devices);
+    if (deviceIds != DeviceIds) {
+        try {
+            Driver->SetFilter(GetDeviceListFilter(deviceIds));
+            Driver->WaitForReady();
+            DeviceIds = deviceIds;
+        } catch (const std::exception& e) {
+            LOG(Warn) << "Can't change MQTT devices filter: " << e.what();
+        }
+    }
+    // Added objects are sent with their values
+    LoadValues();
+
+    LOG(Info) << "Configuration is reloaded: " << addedCount << " information objects added, " << removedCount
+              << " removed, " << (index->Size() - addedCount) << " kept";
+}
+
+IEC104::TInformationObjects TGateway::GetInformationObjectsValues() const noexcept
+{
+    IEC104::TInformationObjects objs;
+    {
+        std::unique_lock<std::mutex> lk(ValuesMutex);
+        for (const auto& value: Values) {
+            Append(objs, value);
+        }
     }
     LOG(Debug) << "TGateway::GetInformationObjectsValues()\n"
                << "\n\tSinglePoint:" << objs.SinglePoint.size()
                << "\n\tMeasuredValueShort:" << objs.MeasuredValueShort.size()
                << "\n\tMeasuredValueScaled:" << objs.MeasuredValueScaled.size()
+               << "\n\tDoublePoint:" << objs.DoublePoint.size()
+               << "\n\tMeasuredValueNormalized:" << objs.MeasuredValueNormalized.size()
+               << "\n\tBitString:" << objs.BitString.size() << "\n\tStepPosition:" << objs.StepPosition.size()
                << "\n\tSinglePointWithTimestamp:" << objs.SinglePointWithTimestamp.size()
                << "\n\tMeasuredValueShortWithTimestamp:" << objs.MeasuredValueShortWithTimestamp.size()
-               << "\n\tMeasuredValueScaledWithTimestamp:" << objs.MeasuredValueScaledWithTimestamp.size();
+               << "\n\tMeasuredValueScaledWithTimestamp:" << objs.MeasuredValueScaledWithTimestamp.size()
+               << "\n\tIntegratedTotals:" << objs.IntegratedTotals.size();
     return objs;
 }
 
-bool TGateway::SetParameter(uint32_t ioa, const std::string& value) noexcept
+bool TGateway::GetStepPosition(const std::shared_ptr<const TPointIndex>& index,
+                               size_t slot,
+                               int step,
+                               int& position) const
 {
-    auto it = IoaToControls.find(ioa);
-    if (it == IoaToControls.end()) {
-        LOG(Warn) << "Can't find configuration for IOA: " << ioa;
+    std::unique_lock<std::mutex> lk(ValuesMutex);
+    // Values can be replaced by reload after the index is taken
+    if (index != Index) {
+        LOG(Warn) << "Configuration is reloaded during step command IOA: " << index->GetObject(slot).Address;
+        return false;
+    }
+    const auto& value = Values[slot];
+    if (value.Object.Type != StepPosition || !value.HasValue) {
+        LOG(Warn) << "Step command IOA: " << value.Object.Address << " is not for step position with known value";
+        return false;
+    }
+    position = value.IntValue + step;
+    if (position < IEC104::STEP_POSITION_MIN || position > IEC104::STEP_POSITION_MAX) {
+        LOG(Warn) << "Step command IOA: " << value.Object.Address << " is beyond the limit of step position";
         return false;
     }
+    return true;
+}
+
+bool TGateway::SetParameters(const std::vector<IEC104::TCommandValue>& values) noexcept
+{
+    if (values.empty()) {
+        return false;
+    }
+    auto index = std::atomic_load(&Index);
 
+    // Objects, step positions and MQTT controls of all values are resolved before publishing,
+    // so a command with an unknown object or control publishes nothing. There is no rollback
+    // of values which are already published if waiting for another one fails
+    std::vector<std::pair<size_t, std::string>> writes; // Slot and MQTT value
+    writes.reserve(values.size());
+    for (const auto& v: values) {
+        auto slot = index->Find(v.Address);
+        if (slot == TPointIndex::NO_SLOT) {
+            LOG(Warn) << "Can't find configuration for IOA: " << v.Address;
+            return false;
+        }
+        if (v.Step) {
+            int position;
+            if (!GetStepPosition(index, slot, v.Step, position)) {
+                return false;
+            }
+            char buf[ValueFormatter::MAX_SIZE];
+            writes.emplace_back(slot, std::string(buf, ValueFormatter::FormatInt(position, buf)));
+        } else {
+            // WBMQTT::TControl::SetRawValue() takes std::string, so the value is copied once here
+            writes.emplace_back(slot, std::string(v.Value.data(), v.ValueSize));
+        }
+    }
+
+    const auto* current = &writes.front();
     try {
         auto tx = Driver->BeginTx();
-        auto pDevice = tx->GetDevice(it->second.Device);
-        if (!pDevice) {
-            throw std::runtime_error("MQTT broker doesn't have '" + it->second.Device + "' device");
+        std::vector<PControl> controls;
+        controls.reserve(writes.size());
+        for (const auto& write: writes) {
+            current = &write;
+            const auto& desc = index->GetControl(write.first);
+            auto pDevice = tx->GetDevice(desc.Device);
+            if (!pDevice) {
+                throw std::runtime_error("MQTT broker doesn't have '" + desc.Device + "' device");
+            }
+            auto pControl = pDevice->GetControl(desc.Control);
+            if (!pControl) {
+                throw std::runtime_error("'" + desc.Device + "' doesn't contain control '" + desc.Control + "'");
+            }
+            controls.push_back(std::move(pControl));
+        }
+
+        // Values are published in one transaction and are waited for together
+        std::vector<TFuture<void>> results;
+        results.reserve(writes.size());
+        for (size_t i = 0; i < writes.size(); ++i) {
+            current = &writes[i];
+            results.push_back(controls[i]->SetRawValue(tx, writes[i].second));
         }
-        auto pControl = pDevice->GetControl(it->second.Control);
-        if (!pControl) {
-            throw std::runtime_error("'" + it->second.Device + "' doesn't contain control '" + it->second.Control +
-                                     "'");
+        for (size_t i = 0; i < results.size(); ++i) {
+            current = &writes[i];
+            results[i].Sync();
+            LOG(Info) << "Set " << GetFullName(controls[i]) << " = '" << writes[i].second << "'";
         }
-        pControl->SetRawValue(tx, value).Sync();
-        LOG(Info) << "Set " << GetFullName(pControl) << " = '" << value << "'";
         return true;
     } catch (std::exception& e) {
-        LOG(Warn) << "Can't execute setup command IOA: " << ioa << ", value: " << value << ": " << e.what();
+        LOG(Warn) << "Can't execute setup command IOA: " << index->GetObject(current->first).Address
+                  << ", value: " << current->second << ": " << e.what();
     }
     return false;
 }
@@ -1,22 +1,51 @@
 #pragma once
 
 #include "IEC104Server.h"
+#include "mpsc_ring.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <wblib/wbmqtt.h>
 
 enum TIecInformationObjectType
 {
-    SinglePoint,                     //! Single point
-    MeasuredValueShort,              //! Measured value short (float)
-    MeasuredValueScaled,             //! Measured value scaled (16-bit signed integer)
-    SinglePointWithTimestamp,        //! Single point with 56bit timestamp
-    MeasuredValueShortWithTimestamp, //! Measured value short (float) with 56bit timestamp
-    MeasuredValueScaledWithTimestamp //! Measured value scaled (16-bit signed integer) with 56bit timestamp
+    SinglePoint,                      //! Single point
+    MeasuredValueShort,               //! Measured value short (float)
+    MeasuredValueScaled,              //! Measured value scaled (16-bit signed integer)
+    SinglePointWithTimestamp,         //! Single point with 56bit timestamp
+    MeasuredValueShortWithTimestamp,  //! Measured value short (float) with 56bit timestamp
+    MeasuredValueScaledWithTimestamp, //! Measured value scaled (16-bit signed integer) with 56bit timestamp
+    IntegratedTotals,                 //! Integrated totals (32-bit counter)
+    IntegratedTotalsWithTimestamp,    //! Integrated totals (32-bit counter) with 56bit timestamp of freeze
+    DoublePoint,                      //! Double point (MQTT 0 - off, 1 - on, 2 - intermediate, 3 - indeterminate)
+    MeasuredValueNormalized,          //! Measured value normalized (-1 to 1)
+    BitString,                        //! Bitstring of 32 bit
+    StepPosition                      //! Step position (-64 to 63)
 };
 
 struct TIecInformationObject
 {
     uint32_t Address; //! Information object address
     TIecInformationObjectType Type;
+
+    //! Measured value is sent spontaneously only if it differs from last sent one more than by Deadband
+    double Deadband = 0;
+
+    //! Measured value is sent spontaneously only if it differs from last sent one more than by DeadbandPercent
+    //! percents of last sent value
+    double DeadbandPercent = 0;
+
+    //! Minimal interval between spontaneous transmissions of measured value
+    std::chrono::milliseconds SendInterval = std::chrono::milliseconds::zero();
+
+    //! MQTT value of counter is multiplied by CounterScale and rounded to integer counter reading
+    double CounterScale = 1;
+
+    //! Value is marked as not topical if it is not received from MQTT during StaleTimeout. 0 - never
+    std::chrono::seconds StaleTimeout = std::chrono::seconds::zero();
 };
 
 // Maps MQTT control name(id) to IEC 60870-5-104 information object address
@@ -31,23 +60,174 @@ struct TControlDesc
     std::string Control; //! MQTT control name /devices/+/controls/XXXX
 };
 
+//! Last successfully converted value of an information object
+struct TIecInformationObjectValue
+{
+    TIecInformationObject Object;
+    bool HasValue = false;
+    union
+    {
+        bool BoolValue;
+        float FloatValue;
+        int IntValue;
+    };
+
+    //! Last value known by IEC masters, used for deadband filtering of measured values
+    double SentValue = 0;
+
+    //! Time of last spontaneous transmission, used for send interval filtering of measured values
+    std::chrono::steady_clock::time_point SentTime;
+
+    //! Time of reception of the value from MQTT or of its quality change.
+    //! It is sent with information objects with timestamp
+    std::chrono::system_clock::time_point Timestamp;
+
+    //! Quality bits derived from MQTT control's error
+    uint8_t ErrorQuality = IEC104::QUALITY_GOOD;
+
+    //! The value is not received from MQTT during stale timeout
+    bool IsStale = false;
+
+    //! Time of last reception of the value from MQTT, used for stale timeout
+    std::chrono::steady_clock::time_point UpdateTime;
+
+    //! Stale timeout timer of the value is in the timer wheel
+    bool HasStaleTimer = false;
+
+    //! Last change of measured value is held back by send interval, it is sent when the interval expires
+    bool IsSendDelayed = false;
+
+    //! Send interval timer of the value is in the timer wheel
+    bool HasSendTimer = false;
+
+    TIecInformationObjectValue(const TIecInformationObject& object): Object(object), IntValue(0)
+    {}
+};
+
+class TPointIndex;
+class TTimerWheel;
+
+//! MQTT value of a control waiting for conversion
+struct TValueChange
+{
+    std::shared_ptr<const TPointIndex> Index; //! Index the slots belong to, it can be replaced by reload
+    size_t FirstSlot;                         //! Slots [FirstSlot, LastSlot) of the control
+    size_t LastSlot;
+    std::string RawValue;
+    std::chrono::system_clock::time_point Time; //! Time of reception
+    std::chrono::steady_clock::time_point SteadyTime;
+};
+
 class TGateway: public IEC104::IHandler
 {
     WBMQTT::PDeviceDriver Driver;
-    TDeviceConfig Devices;
     IEC104::IServer* IecServer;
-    std::map<uint32_t, TControlDesc> IoaToControls; // Maps information object address to MQTT control
+    // Maps MQTT controls and information object addresses to slots. It is replaced as a whole on reload,
+    // so readers without ValuesMutex take a copy of the pointer with std::atomic_load
+    std::shared_ptr<const TPointIndex> Index;
 
-    //! MQTT value changing handler
+    WBMQTT::PMqttClient MqttClient; // Subscribed to errors of controls, can be null
+    std::vector<std::string> DeviceIds; // Devices of MQTT driver's filter
+
+    // Values are passed to IEC server under ValuesMutex, so they can't overtake reconfiguration of the server
+    mutable std::mutex ValuesMutex;
+    std::vector<TIecInformationObjectValue> Values; // Last known values indexed by slots
+
+    // MQTT callback only puts raw values to the queue, they are converted and sent in batches by conversion thread
+    TMpscRing<TValueChange> Changes;
+    std::atomic<uint64_t> PushedChanges{0};
+    std::atomic<bool> ConversionThreadIsWaiting{false};
+    std::atomic<bool> StopConversionThread{false};
+    std::mutex ChangesMutex;
+    std::condition_variable ChangesCv;   // Wakes conversion thread
+    std::condition_variable ProcessedCv; // Wakes WaitForChanges
+    uint64_t ProcessedChanges = 0;       // Guarded by ChangesMutex
+    std::thread ConversionThread;
+    std::vector<std::pair<size_t, TIecInformationObjectValue>> ConvertedValues; // Used only by conversion thread
+
+    // All stale timeouts are checked by one thread with timer wheel. Guarded by ValuesMutex
+    std::unique_ptr<TTimerWheel> StaleTimers;
+    std::condition_variable StaleCv;
+    std::thread StaleThread;
+    bool StopStaleThread = false;
+
+    // Changes held back by send intervals are sent by one thread with timer wheel. Guarded by ValuesMutex
+    std::unique_ptr<TTimerWheel> SendTimers;
+    std::condition_variable SendCv;
+    std::thread SendThread;
+    bool StopSendThread = false;
+
+    //! MQTT value changing handler, puts the value to the conversion queue
     void OnValueChanged(const WBMQTT::TControlValueEvent& event);
 
+    //! Convert queued values in batches and send them
+    void ConversionLoop();
+
+    //! Convert values, update values cache and send changes
+    void ProcessChanges(const std::vector<TValueChange>& changes);
+
+    void StopConversionLoop();
+
+    //! MQTT control's error changing handler
+    void OnErrorChanged(const WBMQTT::TMqttMessage& message);
+
+    //! Fill values cache with current values of controls which are not received yet and send them spontaneously
+    void LoadValues();
+
+    //! Start stale thread if any value has stale timeout
+    void StartStaleLoop();
+
+    //! Arm stale timeout of the value in slot if it is not armed yet. ValuesMutex must be locked
+    void SetStaleTimer(size_t slot);
+
+    //! Mark values which are not refreshed during stale timeout as not topical and send them
+    void StaleLoop();
+
+    void StopStaleLoop();
+
+    //! Start send interval thread if any value has send interval
+    void StartSendLoop();
+
+    //! Arm send interval timer of the value in slot if its last change is held back. ValuesMutex must be locked
+    void SetSendTimer(size_t slot);
+
+    //! Send last changes which were held back by send intervals when the intervals expire
+    void SendLoop();
+
+    void StopSendLoop();
+
+    //! Get position of step position information object in slot after a step of regulating step command
+    bool GetStepPosition(const std::shared_ptr<const TPointIndex>& index, size_t slot, int step, int& position) const;
+
 public:
-    TGateway(WBMQTT::PDeviceDriver driver, IEC104::IServer* iecServer, const TDeviceConfig& devices);
+    /**
+     * @brief Create the gateway
+     *
+     * @param mqttClient client to subscribe to errors of controls. Errors are used as quality of information
+     *                   objects. If it is null, only errors of controls at startup are taken into account
+     */
+    TGateway(WBMQTT::PDeviceDriver driver,
+             IEC104::IServer* iecServer,
+             const TDeviceConfig& devices,
+             WBMQTT::PMqttClient mqttClient = nullptr);
+    ~TGateway();
 
     //! Stop the server
     void Stop();
 
+    /**
+     * @brief Apply new configuration of information objects without dropping IEC connections.
+     *        Values of kept information objects are preserved, removed ones are sent as invalid,
+     *        added ones are sent as soon as their values are read from MQTT
+     *
+     * @param iecConfig only settings of information objects are applied, see IEC104::IServer::Reconfigure
+     */
+    void Reload(const TDeviceConfig& devices, const IEC104::TServerConfig& iecConfig);
+
+    //! Wait until all MQTT values received before the call are converted and passed to IEC server
+    void WaitForChanges();
+
     // IEC104::IHandler implementation
     IEC104::TInformationObjects GetInformationObjectsValues() const noexcept;
-    bool SetParameter(uint32_t ioa, const std::string& value) noexcept;
+    bool SetParameters(const std::vector<IEC104::TCommandValue>& values) noexcept;
 };
@@ -0,0 +1,85 @@
+#include "information_object_encoder.h"
+
+#include "information_objects_internal.h"
+
+#include "log.h"
+
+#define LOG(logger) ::logger.Log() << "[IEC] "
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TSinglePointInformationObject& obj)
+{
+    sSinglePointInformation storage;
+    auto io = SinglePointInformation_create(&storage, obj.Address, obj.Value, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TMeasuredValueShortInformationObject& obj)
+{
+    sMeasuredValueShort storage;
+    auto io = MeasuredValueShort_create(&storage, obj.Address, obj.Value, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TMeasuredValueScaledInformationObject& obj)
+{
+    sMeasuredValueScaled storage;
+    auto io = MeasuredValueScaled_create(&storage, obj.Address, obj.Value, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TDoublePointInformationObject& obj)
+{
+    sDoublePointInformation storage;
+    auto io = DoublePointInformation_create(&storage, obj.Address, (DoublePointValue)obj.Value, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TMeasuredValueNormalizedInformationObject& obj)
+{
+    sMeasuredValueNormalized storage;
+    auto io = MeasuredValueNormalized_create(&storage, obj.Address, obj.Value, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TBitStringInformationObject& obj)
+{
+    sBitString32 storage;
+    auto io = BitString32_createEx(&storage, obj.Address, obj.Value, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TStepPositionInformationObject& obj)
+{
+    sStepPositionInformation storage;
+    auto io = StepPositionInformation_create(&storage, obj.Address, obj.Value, false, obj.Quality);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TSinglePointInformationObjectWithTimestamp& obj)
+{
+    sSinglePointWithCP56Time2a storage;
+    auto timestamp = MakeTimestamp(obj.Timestamp);
+    auto io = SinglePointWithCP56Time2a_create(&storage, obj.Address, obj.Value, obj.Quality, &timestamp);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TMeasuredValueShortInformationObjectWithTimestamp& obj)
+{
+    sMeasuredValueShortWithCP56Time2a storage;
+    auto timestamp = MakeTimestamp(obj.Timestamp);
+    auto io = MeasuredValueShortWithCP56Time2a_create(&storage, obj.Address, obj.Value, obj.Quality, &timestamp);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+bool IEC104::AddInformationObject(CS101_ASDU asdu, const TMeasuredValueScaledInformationObjectWithTimestamp& obj)
+{
+    sMeasuredValueScaledWithCP56Time2a storage;
+    auto timestamp = MakeTimestamp(obj.Timestamp);
+    auto io = MeasuredValueScaledWithCP56Time2a_create(&storage, obj.Address, obj.Value, obj.Quality, &timestamp);
+    return CS101_ASDU_addInformationObject(asdu, (InformationObject)io);
+}
+
+void IEC104::LogNotAddedObject(uint32_t address)
+{
+    LOG(Warn) << "Can't add information object with address " << address << " to ASDU";
+}
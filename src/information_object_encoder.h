@@ -0,0 +1,184 @@
+#pragma once
+
+#include "IEC104Server.h"
+
+#include "cs101_information_objects.h"
+#include "iec60870_common.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Convert time to CP56Time2a. Objects of one change share the timestamp and are encoded
+     *        for spontaneous transmission and for interrogation image one after another,
+     *        so the last conversion is remembered and calendar calculation is done once per change.
+     */
+    inline sCP56Time2a MakeTimestamp(const std::chrono::system_clock::time_point& ts)
+    {
+        thread_local uint64_t lastMs = 0;
+        thread_local sCP56Time2a lastTimestamp;
+        uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(ts.time_since_epoch()).count();
+        if (ms != lastMs || ms == 0) {
+            CP56Time2a_createFromMsTimestamp(&lastTimestamp, ms);
+            lastMs = ms;
+        }
+        return lastTimestamp;
+    }
+
+    //! Compile-time type identification of gateway's information objects
+    template<class T> struct TInformationObjectTraits;
+
+    template<> struct TInformationObjectTraits<TSinglePointInformationObject>
+    {
+        static constexpr TypeID Type = M_SP_NA_1;
+    };
+
+    template<> struct TInformationObjectTraits<TMeasuredValueShortInformationObject>
+    {
+        static constexpr TypeID Type = M_ME_NC_1;
+    };
+
+    template<> struct TInformationObjectTraits<TMeasuredValueScaledInformationObject>
+    {
+        static constexpr TypeID Type = M_ME_NB_1;
+    };
+
+    template<> struct TInformationObjectTraits<TDoublePointInformationObject>
+    {
+        static constexpr TypeID Type = M_DP_NA_1;
+    };
+
+    template<> struct TInformationObjectTraits<TMeasuredValueNormalizedInformationObject>
+    {
+        static constexpr TypeID Type = M_ME_NA_1;
+    };
+
+    template<> struct TInformationObjectTraits<TBitStringInformationObject>
+    {
+        static constexpr TypeID Type = M_BO_NA_1;
+    };
+
+    template<> struct TInformationObjectTraits<TStepPositionInformationObject>
+    {
+        static constexpr TypeID Type = M_ST_NA_1;
+    };
+
+    template<> struct TInformationObjectTraits<TSinglePointInformationObjectWithTimestamp>
+    {
+        static constexpr TypeID Type = M_SP_TB_1;
+    };
+
+    template<> struct TInformationObjectTraits<TMeasuredValueShortInformationObjectWithTimestamp>
+    {
+        static constexpr TypeID Type = M_ME_TF_1;
+    };
+
+    template<> struct TInformationObjectTraits<TMeasuredValueScaledInformationObjectWithTimestamp>
+    {
+        static constexpr TypeID Type = M_ME_TE_1;
+    };
+
+    /**
+     * @brief Add information object to ASDU. The object is created on stack in lib60870 structure,
+     *        so no memory is allocated. Returns false if the ASDU can't take the object
+     */
+    bool AddInformationObject(CS101_ASDU asdu, const TSinglePointInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TMeasuredValueShortInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TMeasuredValueScaledInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TDoublePointInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TMeasuredValueNormalizedInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TBitStringInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TStepPositionInformationObject& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TSinglePointInformationObjectWithTimestamp& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TMeasuredValueShortInformationObjectWithTimestamp& obj);
+    bool AddInformationObject(CS101_ASDU asdu, const TMeasuredValueScaledInformationObjectWithTimestamp& obj);
+
+    //! Log information object which doesn't fit into empty ASDU
+    void LogNotAddedObject(uint32_t address);
+
+    //! Call fn for every vector of information objects of the same type
+    template<class TFn> void ForEachType(const TInformationObjects& objs, TFn&& fn)
+    {
+        fn(objs.SinglePoint);
+        fn(objs.MeasuredValueShort);
+        fn(objs.MeasuredValueScaled);
+        fn(objs.DoublePoint);
+        fn(objs.MeasuredValueNormalized);
+        fn(objs.BitString);
+        fn(objs.StepPosition);
+        fn(objs.SinglePointWithTimestamp);
+        fn(objs.MeasuredValueShortWithTimestamp);
+        fn(objs.MeasuredValueScaledWithTimestamp);
+    }
+
+    /**
+     * @brief Packs information objects into ASDUs. ASDU is built in a reusable buffer inside the object,
+     *        information objects are created on stack, so no memory is allocated.
+     */
+    template<class TSendFn> class TAsduWriter
+    {
+        CS101_AppLayerParameters Parameters;
+        CS101_CauseOfTransmission Cot;
+        int CommonAddress;
+        TSendFn& SendFn;
+        sCS101_StaticASDU Buffer;
+        CS101_ASDU Asdu;
+
+        void Reset()
+        {
+            Asdu = CS101_ASDU_initializeStatic(&Buffer, Parameters, false, Cot, 0, CommonAddress, false, false);
+        }
+
+    public:
+        TAsduWriter(CS101_AppLayerParameters parameters,
+                    CS101_CauseOfTransmission cot,
+                    int commonAddress,
+                    TSendFn& sendFn)
+            : Parameters(parameters),
+              Cot(cot),
+              CommonAddress(commonAddress),
+              SendFn(sendFn)
+        {
+            Reset();
+        }
+
+        TAsduWriter(const TAsduWriter&) = delete;
+        TAsduWriter& operator=(const TAsduWriter&) = delete;
+
+        //! Add information object to current ASDU. Full ASDU or ASDU of other type is sent before
+        template<class T> void Append(const T& obj)
+        {
+            if (!AddInformationObject(Asdu, obj)) {
+                Flush();
+                if (!AddInformationObject(Asdu, obj)) {
+                    LogNotAddedObject(obj.Address);
+                }
+            }
+        }
+
+        //! Send current ASDU if it is not empty
+        void Flush()
+        {
+            if (CS101_ASDU_getPayloadSize(Asdu)) {
+                SendFn(Asdu);
+                Reset();
+            }
+        }
+    };
+
+    //! Pack information objects into ASDUs and pass them to sendFn
+    template<class TSendFn>
+    void Send(CS101_AppLayerParameters appLayerParameters,
+              int commonAddress,
+              CS101_CauseOfTransmission cot,
+              const TInformationObjects& objs,
+              TSendFn&& sendFn)
+    {
+        TAsduWriter<TSendFn> writer(appLayerParameters, cot, commonAddress, sendFn);
+        ForEachType(objs, [&](const auto& typedObjs) {
+            for (const auto& obj: typedObjs) {
+                writer.Append(obj);
+            }
+        });
+        writer.Flush();
+    }
+}
@@ -0,0 +1,172 @@
+#include "interrogation_image.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    //! Sequences of elements (SQ=1) are defined only for types without timestamp
+    bool IsSequenceAllowed(TypeID type)
+    {
+        switch (type) {
+            case M_SP_NA_1:
+            case M_DP_NA_1:
+            case M_ST_NA_1:
+            case M_BO_NA_1:
+            case M_ME_NA_1:
+            case M_ME_NB_1:
+            case M_ME_NC_1:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Order of blocks in TInterrogationImage
+    template<class T> constexpr size_t BlockIndex();
+    template<> constexpr size_t BlockIndex<IEC104::TSinglePointInformationObject>()
+    {
+        return 0;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TMeasuredValueShortInformationObject>()
+    {
+        return 1;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TMeasuredValueScaledInformationObject>()
+    {
+        return 2;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TSinglePointInformationObjectWithTimestamp>()
+    {
+        return 3;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TMeasuredValueShortInformationObjectWithTimestamp>()
+    {
+        return 4;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TMeasuredValueScaledInformationObjectWithTimestamp>()
+    {
+        return 5;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TDoublePointInformationObject>()
+    {
+        return 6;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TMeasuredValueNormalizedInformationObject>()
+    {
+        return 7;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TBitStringInformationObject>()
+    {
+        return 8;
+    }
+    template<> constexpr size_t BlockIndex<IEC104::TStepPositionInformationObject>()
+    {
+        return 9;
+    }
+}
+
+IEC104::TInterrogationImage::TInterrogationImage(CS101_AppLayerParameters parameters,
+                                                 const TInterrogationGroups& groups,
+                                                 bool sequenceEncoding)
+    : Parameters(parameters),
+      Groups(groups)
+{
+    MaxPayloadSize = parameters->maxSizeOfASDU -
+                     (parameters->sizeOfTypeId + parameters->sizeOfVSQ + parameters->sizeOfCOT + parameters->sizeOfCA);
+    ForEachType(TInformationObjects(), [this, sequenceEncoding](const auto& objs) {
+        typedef typename std::decay_t<decltype(objs)>::value_type TObject;
+        for (size_t i = 0; i < Images.size(); ++i) {
+            auto& block = GetBlock<TObject>(i);
+            block.Type = TInformationObjectTraits<TObject>::Type;
+            block.UseSequences = sequenceEncoding && IsSequenceAllowed(block.Type);
+        }
+    });
+}
+
+template<class T> IEC104::TInterrogationImage::TBlock& IEC104::TInterrogationImage::GetBlock(size_t image)
+{
+    return Images[image][BlockIndex<T>()];
+}
+
+void IEC104::TInterrogationImage::Patch(TBlock& block, uint32_t address, const uint8_t* payload)
+{
+    auto it = block.Offsets.find(address);
+    if (it == block.Offsets.end()) {
+        block.Offsets.emplace(address, block.Data.size());
+        block.Data.insert(block.Data.end(), payload, payload + block.ElementSize);
+        block.IsSorted = false;
+    } else {
+        memcpy(block.Data.data() + it->second, payload, block.ElementSize);
+    }
+}
+
+void IEC104::TInterrogationImage::Sort(TBlock& block)
+{
+    std::vector<std::pair<uint32_t, size_t>> elements(block.Offsets.begin(), block.Offsets.end());
+    std::sort(elements.begin(), elements.end());
+    std::vector<uint8_t> data;
+    data.reserve(block.Data.size());
+    block.Runs.clear();
+    for (size_t i = 0; i < elements.size(); ++i) {
+        const auto& element = elements[i];
+        if (i && element.first == elements[i - 1].first + 1) {
+            ++block.Runs.back().Count;
+        } else {
+            block.Runs.push_back({i, 1});
+        }
+        block.Offsets[element.first] = data.size();
+        auto first = block.Data.begin() + element.second;
+        data.insert(data.end(), first, first + block.ElementSize);
+    }
+    block.Data.swap(data);
+    block.IsSorted = true;
+}
+
+size_t IEC104::TInterrogationImage::GetMaxElementsInAsdu(const TBlock& block) const
+{
+    return std::min(MaxPayloadSize / block.ElementSize, MAX_ELEMENTS_IN_ASDU);
+}
+
+void IEC104::TInterrogationImage::Update(const TInformationObjects& objs)
+{
+    ForEachType(objs, [this](const auto& typedObjs) {
+        typedef typename std::decay_t<decltype(typedObjs)>::value_type TObject;
+        auto& block = GetBlock<TObject>(0);
+        for (const auto& obj: typedObjs) {
+            sCS101_StaticASDU staticAsdu;
+            auto asdu =
+                CS101_ASDU_initializeStatic(&staticAsdu, Parameters, false, CS101_COT_SPONTANEOUS, 0, 0, false, false);
+            if (!AddInformationObject(asdu, obj)) {
+                continue;
+            }
+            auto payload = CS101_ASDU_getPayload(asdu);
+            block.ElementSize = CS101_ASDU_getPayloadSize(asdu);
+            Patch(block, obj.Address, payload);
+            if (!Groups.empty()) {
+                auto group = Groups.find(obj.Address);
+                if (group != Groups.end()) {
+                    auto& groupBlock = GetBlock<TObject>(group->second);
+                    groupBlock.ElementSize = block.ElementSize;
+                    Patch(groupBlock, obj.Address, payload);
+                }
+            }
+        }
+    });
+    for (auto& blocks: Images) {
+        for (auto& block: blocks) {
+            if (!block.IsSorted && block.UseSequences) {
+                Sort(block);
+            }
+        }
+    }
+}
+
+size_t IEC104::TInterrogationImage::Size() const
+{
+    size_t res = 0;
+    for (const auto& block: Images[0]) {
+        res += block.Offsets.size();
+    }
+    return res;
+}
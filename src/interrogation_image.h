@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include "information_object_encoder.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Pre-encoded values of information objects.
+     *        Objects of the same type are stored as a packed array of ASDU payload elements,
+     *        so an interrogation response is built by copying ready chunks into ASDUs.
+     *        Objects of interrogation groups are additionally stored in separate per group arrays,
+     *        so a group interrogation response doesn't touch objects of other groups.
+     *        Changed objects are patched in place.
+     *        If sequence encoding is enabled, elements are kept sorted by address and runs of consecutive addresses
+     *        of types without timestamp are sent as sequences of elements (SQ=1), so only the first element
+     *        of an ASDU carries the address. New objects are sorted once per Update call.
+     *        The class is not threadsafe.
+     */
+    class TInterrogationImage
+    {
+    public:
+        /**
+         * @brief Construct a new image
+         *
+         * @param parameters application layer parameters for ASDU encoding
+         * @param groups interrogation groups (1-16) of information objects.
+         *               Objects without group are sent only on station interrogation
+         * @param sequenceEncoding send runs of consecutive addresses as sequences of elements (SQ=1)
+         */
+        TInterrogationImage(CS101_AppLayerParameters parameters,
+                            const TInterrogationGroups& groups = {},
+                            bool sequenceEncoding = false);
+
+        //! Add new information objects to the image or patch existing ones
+        void Update(const TInformationObjects& objs);
+
+        //! Pack all information objects into ASDUs and pass them to sendFn
+        template<class TSendFn> void Send(CS101_CauseOfTransmission cot, int commonAddress, TSendFn&& sendFn) const
+        {
+            Send(Images[0], cot, commonAddress, sendFn);
+        }
+
+        //! Pack information objects of interrogation group (1-16) into ASDUs and pass them to sendFn
+        template<class TSendFn>
+        void SendGroup(uint8_t group, CS101_CauseOfTransmission cot, int commonAddress, TSendFn&& sendFn) const
+        {
+            if (group > 0 && group < Images.size()) {
+                Send(Images[group], cot, commonAddress, sendFn);
+            }
+        }
+
+        //! Number of information objects in the image
+        size_t Size() const;
+
+    private:
+        //! Elements [First, First + Count) of a block with consecutive addresses
+        struct TRun
+        {
+            size_t First;
+            size_t Count;
+        };
+
+        struct TBlock
+        {
+            TypeID Type;
+            size_t ElementSize = 0;                        // Size of encoded IOA and value
+            std::vector<uint8_t> Data;                     // Packed encoded elements
+            std::unordered_map<uint32_t, size_t> Offsets; // Maps information object address to offset in Data
+            bool UseSequences = false;                     // Elements are sorted by address and sent in runs
+            bool IsSorted = true;
+            std::vector<TRun> Runs;
+        };
+
+        typedef std::array<TBlock, 10> TBlocks;
+
+        //! Number of elements in ASDU is stored in 7 bits of variable structure qualifier
+        static constexpr size_t MAX_ELEMENTS_IN_ASDU = 127;
+
+        CS101_AppLayerParameters Parameters;
+        size_t MaxPayloadSize;
+        TInterrogationGroups Groups;
+
+        //! Blocks of all objects followed by blocks of interrogation groups 1-16
+        std::array<TBlocks, MAX_INTERROGATION_GROUP + 1> Images;
+
+        size_t GetMaxElementsInAsdu(const TBlock& block) const;
+
+        template<class T> TBlock& GetBlock(size_t image);
+
+        static void Patch(TBlock& block, uint32_t address, const uint8_t* payload);
+
+        //! Sort elements of the block by address and find runs of consecutive addresses
+        static void Sort(TBlock& block);
+
+        template<class TSendFn>
+        void SendSequences(const TBlock& block, CS101_CauseOfTransmission cot, int commonAddress, TSendFn& sendFn) const
+        {
+            const size_t ioaSize = Parameters->sizeOfIOA;
+            const size_t valueSize = block.ElementSize - ioaSize;
+            const size_t maxSequenceSize = std::min((MaxPayloadSize - ioaSize) / valueSize, MAX_ELEMENTS_IN_ASDU);
+            const size_t maxElements = GetMaxElementsInAsdu(block);
+
+            // Elements without neighbours are gathered into ordinary ASDUs
+            sCS101_StaticASDU singlesBuffer;
+            CS101_ASDU singles = nullptr;
+            size_t singlesCount = 0;
+
+            for (const auto& run: block.Runs) {
+                const uint8_t* data = block.Data.data() + run.First * block.ElementSize;
+                if (run.Count == 1) {
+                    if (!singlesCount) {
+                        singles = CS101_ASDU_initializeStatic(&singlesBuffer,
+                                                              Parameters,
+                                                              false,
+                                                              cot,
+                                                              0,
+                                                              commonAddress,
+                                                              false,
+                                                              false);
+                        CS101_ASDU_setTypeID(singles, block.Type);
+                    }
+                    CS101_ASDU_addPayload(singles, const_cast<uint8_t*>(data), block.ElementSize);
+                    if (++singlesCount == maxElements) {
+                        CS101_ASDU_setNumberOfElements(singles, singlesCount);
+                        sendFn(singles);
+                        singlesCount = 0;
+                    }
+                    continue;
+                }
+                for (size_t i = 0; i < run.Count; i += maxSequenceSize) {
+                    const size_t count = std::min(maxSequenceSize, run.Count - i);
+                    const uint8_t* element = data + i * block.ElementSize;
+                    sCS101_StaticASDU staticAsdu;
+                    auto asdu =
+                        CS101_ASDU_initializeStatic(&staticAsdu, Parameters, true, cot, 0, commonAddress, false, false);
+                    CS101_ASDU_setTypeID(asdu, block.Type);
+                    CS101_ASDU_addPayload(asdu, const_cast<uint8_t*>(element), ioaSize);
+                    for (size_t j = 0; j < count; ++j, element += block.ElementSize) {
+                        CS101_ASDU_addPayload(asdu, const_cast<uint8_t*>(element + ioaSize), valueSize);
+                    }
+                    CS101_ASDU_setNumberOfElements(asdu, count);
+                    sendFn(asdu);
+                }
+            }
+            if (singlesCount) {
+                CS101_ASDU_setNumberOfElements(singles, singlesCount);
+                sendFn(singles);
+            }
+        }
+
+        template<class TSendFn>
+        void Send(const TBlocks& blocks, CS101_CauseOfTransmission cot, int commonAddress, TSendFn& sendFn) const
+        {
+            for (const auto& block: blocks) {
+                if (block.Data.empty()) {
+                    continue;
+                }
+                if (block.UseSequences) {
+                    SendSequences(block, cot, commonAddress, sendFn);
+                    continue;
+                }
+                const size_t maxChunkSize = GetMaxElementsInAsdu(block) * block.ElementSize;
+                for (size_t offset = 0; offset < block.Data.size(); offset += maxChunkSize) {
+                    size_t chunkSize = std::min(maxChunkSize, block.Data.size() - offset);
+                    sCS101_StaticASDU staticAsdu;
+                    auto asdu = CS101_ASDU_initializeStatic(&staticAsdu,
+                                                            Parameters,
+                                                            false,
+                                                            cot,
+                                                            0,
+                                                            commonAddress,
+                                                            false,
+                                                            false);
+                    CS101_ASDU_setTypeID(asdu, block.Type);
+                    CS101_ASDU_addPayload(asdu, const_cast<uint8_t*>(block.Data.data() + offset), chunkSize);
+                    CS101_ASDU_setNumberOfElements(asdu, chunkSize / block.ElementSize);
+                    sendFn(asdu);
+                }
+            }
+        }
+    };
+}
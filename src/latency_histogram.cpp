@@ -0,0 +1,72 @@
+#include "latency_histogram.h"
+
+#include <cmath>
+
+namespace
+{
+    size_t GetBucket(int64_t us)
+    {
+        size_t bucket = 0;
+        while (us > 0 && bucket < TLatencyHistogram::BUCKETS_COUNT - 1) {
+            us >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+}
+
+TLatencyHistogram::TLatencyHistogram(): Count(0), MaxUs(0)
+{
+    for (auto& bucket: Buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void TLatencyHistogram::Add(std::chrono::steady_clock::duration latency)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    Buckets[GetBucket(us)].fetch_add(1, std::memory_order_relaxed);
+    Count.fetch_add(1, std::memory_order_relaxed);
+    auto max = MaxUs.load(std::memory_order_relaxed);
+    while (us > max && !MaxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t TLatencyHistogram::GetCount() const
+{
+    return Count.load(std::memory_order_relaxed);
+}
+
+std::chrono::microseconds TLatencyHistogram::GetPercentile(double percentile) const
+{
+    uint64_t buckets[BUCKETS_COUNT];
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+        buckets[i] = Buckets[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+    if (count == 0) {
+        return std::chrono::microseconds::zero();
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(count * percentile / 100));
+    uint64_t sum = 0;
+    for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+        sum += buckets[i];
+        if (sum >= rank && sum > 0) {
+            return std::chrono::microseconds(int64_t(1) << i);
+        }
+    }
+    return GetMax();
+}
+
+std::chrono::microseconds TLatencyHistogram::GetMax() const
+{
+    return std::chrono::microseconds(MaxUs.load(std::memory_order_relaxed));
+}
+
+std::ostream& operator<<(std::ostream& str, const TLatencyHistogram& histogram)
+{
+    return str << "count: " << histogram.GetCount() << ", p50: <" << histogram.GetPercentile(50).count()
+               << "us, p90: <" << histogram.GetPercentile(90).count() << "us, p99: <"
+               << histogram.GetPercentile(99).count() << "us, max: " << histogram.GetMax().count() << "us";
+}
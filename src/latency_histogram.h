@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+/**
+ * @brief Histogram of latencies with power of two microsecond buckets.
+ *        Adding samples is lock-free and threadsafe, reading is threadsafe but not atomic across buckets.
+ */
+class TLatencyHistogram
+{
+public:
+    //! Bucket 0 counts latencies less than 1us, bucket i counts latencies in [2^(i-1), 2^i) us
+    static const size_t BUCKETS_COUNT = 32;
+
+    TLatencyHistogram();
+
+    void Add(std::chrono::steady_clock::duration latency);
+
+    uint64_t GetCount() const;
+
+    //! Upper bound of bucket containing given percentile (0-100) of samples. Zero if there are no samples
+    std::chrono::microseconds GetPercentile(double percentile) const;
+
+    std::chrono::microseconds GetMax() const;
+
+private:
+    std::atomic<uint64_t> Buckets[BUCKETS_COUNT];
+    std::atomic<uint64_t> Count;
+    std::atomic<int64_t> MaxUs;
+};
+
+//! Print count, p50, p90, p99 and max latencies
+std::ostream& operator<<(std::ostream& str, const TLatencyHistogram& histogram);
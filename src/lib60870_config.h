@@ -60,9 +60,10 @@
 #define CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP 1
 
 /**
- * Set the maximum number of client connections
+ * Set the maximum number of client connections.
+ * It is an upper limit, actual limit is set by iec104.max_connections setting
  */
-#define CONFIG_CS104_MAX_CLIENT_CONNECTIONS 5
+#define CONFIG_CS104_MAX_CLIENT_CONNECTIONS 32
 
 /* activate TCP keep alive mechanism. 1 -> activate */
 #define CONFIG_ACTIVATE_TCP_KEEPALIVE 0
@@ -1,4 +1,5 @@
 #include <getopt.h>
+#include <tuple>
 
 #include <wblib/signal_handling.h>
 #include <wblib/wbmqtt.h>
@@ -6,6 +7,7 @@
 #include "config_parser.h"
 #include "iec104_exception.h"
 #include "log.h"
+#include "statistics_publisher.h"
 
 #define LOG(logger) ::logger.Log() << "[main] "
 
@@ -29,6 +31,35 @@ const auto EXIT_NOTRUNNING = 7;    // Nothing for service to do; do not auto-res
 
 namespace
 {
+    //! Settings of IEC server except settings of information objects are applied only on restart
+    bool IsRestartRequired(const IEC104::TServerConfig& oldConfig, const IEC104::TServerConfig& newConfig)
+    {
+        if (oldConfig.RedundancyGroups.size() != newConfig.RedundancyGroups.size()) {
+            return true;
+        }
+        for (size_t i = 0; i < oldConfig.RedundancyGroups.size(); ++i) {
+            if (oldConfig.RedundancyGroups[i].Name != newConfig.RedundancyGroups[i].Name ||
+                oldConfig.RedundancyGroups[i].AllowedClients != newConfig.RedundancyGroups[i].AllowedClients)
+            {
+                return true;
+            }
+        }
+        auto tie = [](const IEC104::TServerConfig& c) {
+            return std::tie(c.BindIp,
+                            c.BindPort,
+                            c.CoalesceWindow,
+                            c.CoalesceMaxObjects,
+                            c.KeepEventsHistory,
+                            c.MaxPendingCommands,
+                            c.SendActTerm,
+                            c.QueueSize,
+                            c.MaxConnections,
+                            c.JournalFile,
+                            c.JournalSize,
+                            c.JournalOverflowPolicy);
+        };
+        return tie(oldConfig) != tie(newConfig);
+    }
 
     void PrintStartupInfo()
     {
@@ -114,7 +145,7 @@ int main(int argc, char* argv[])
     string configFile(CONFIG_FULL_FILE_PATH);
 
     TPromise<void> initialized;
-    SignalHandling::Handle({SIGINT, SIGTERM});
+    SignalHandling::Handle({SIGINT, SIGTERM, SIGHUP});
     SignalHandling::OnSignals({SIGINT, SIGTERM}, [&] { SignalHandling::Stop(); });
     SetThreadName(APP_NAME);
 
@@ -146,13 +177,39 @@ int main(int argc, char* argv[])
         auto driver = NewDriver(TDriverArgs{}.SetId(APP_NAME).SetBackend(backend));
 
         driver->StartLoop();
-        driver->WaitForReady();
 
+        // IEC server accepts connections while the gateway waits for synchronization with MQTT
         auto IecServer(IEC104::MakeServer(config.Iec));
 
-        TGateway gateway(driver, IecServer.get(), config.Devices);
+        TGateway gateway(driver, IecServer.get(), config.Devices, mqtt);
 
-        SignalHandling::OnSignals({SIGINT, SIGTERM}, [&] { gateway.Stop(); });
+        std::unique_ptr<TStatisticsPublisher> statisticsPublisher;
+        if (config.StatisticsInterval.count()) {
+            statisticsPublisher = std::make_unique<TStatisticsPublisher>(driver, config.StatisticsInterval);
+        }
+
+        SignalHandling::OnSignals({SIGINT, SIGTERM}, [&] {
+            if (statisticsPublisher) {
+                statisticsPublisher->Stop();
+            }
+            gateway.Stop();
+        });
+
+        // Information objects are reloaded without dropping IEC connections
+        SignalHandling::OnSignals({SIGHUP}, [&] {
+            LOG(Info) << "Reloading configuration";
+            try {
+                auto newConfig(LoadConfig(configFile, CONFIG_JSON_SCHEMA_FULL_FILE_PATH));
+                if (IsRestartRequired(config.Iec, newConfig.Iec)) {
+                    LOG(Warn) << "IEC 60870-5-104 server settings are changed, they will be applied after restart";
+                }
+                gateway.Reload(newConfig.Devices, newConfig.Iec);
+            } catch (const TEmptyConfigException& e) {
+                LOG(Error) << "All groups are disabled in config file, configuration is not reloaded";
+            } catch (const exception& e) {
+                LOG(Error) << "Can't reload configuration: " << e.what();
+            }
+        });
 
         initialized.Complete();
         SignalHandling::Wait();
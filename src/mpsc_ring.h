@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief Bounded lock-free queue for many producers and one consumer.
+ *        Every cell has a sequence number which tells if the cell is free for the producer owning the position
+ *        or is filled for the consumer, so producers and the consumer don't share anything but the cells.
+ *        Capacity is rounded up to a power of two.
+ */
+template<class T> class TMpscRing
+{
+public:
+    explicit TMpscRing(size_t capacity): Mask(RoundUp(capacity) - 1), Cells(new TCell[Mask + 1]), Head(0), Tail(0)
+    {
+        for (size_t i = 0; i <= Mask; ++i) {
+            Cells[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    TMpscRing(const TMpscRing&) = delete;
+    TMpscRing& operator=(const TMpscRing&) = delete;
+
+    //! Push the value if the queue is not full. The value is moved only on success. Threadsafe
+    bool TryPush(T&& value)
+    {
+        auto pos = Head.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& cell = Cells[pos & Mask];
+            auto seq = cell.Sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (Head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.Value = std::move(value);
+                    cell.Sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The cell is not consumed yet after previous turn
+                return false;
+            } else {
+                pos = Head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //! Pop the oldest value if the queue is not empty. Must be called only from consumer's thread
+    bool TryPop(T& value)
+    {
+        auto& cell = Cells[Tail & Mask];
+        if (cell.Sequence.load(std::memory_order_acquire) != Tail + 1) {
+            return false;
+        }
+        value = std::move(cell.Value);
+        cell.Sequence.store(Tail + Mask + 1, std::memory_order_release);
+        ++Tail;
+        return true;
+    }
+
+    size_t Capacity() const
+    {
+        return Mask + 1;
+    }
+
+private:
+    struct TCell
+    {
+        std::atomic<size_t> Sequence;
+        T Value;
+    };
+
+    static size_t RoundUp(size_t capacity)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("Queue capacity must be positive");
+        }
+        size_t res = 1;
+        while (res < capacity) {
+            res <<= 1;
+        }
+        return res;
+    }
+
+    const size_t Mask;
+    std::unique_ptr<TCell[]> Cells;
+    alignas(64) std::atomic<size_t> Head; // Next position to push
+    alignas(64) size_t Tail;              // Next position to pop, used only by the consumer
+};
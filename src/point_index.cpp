@@ -0,0 +1,161 @@
+#include "point_index.h"
+
+#include <limits>
+
+const size_t TPointIndex::NO_SLOT = std::numeric_limits<size_t>::max();
+
+namespace
+{
+    const uint32_t NO_IOA_SLOT = std::numeric_limits<uint32_t>::max();
+
+    // Direct IOA table is used if it is not bigger than DENSE_IOA_FACTOR * number of information objects
+    const size_t DENSE_IOA_FACTOR = 4;
+    const size_t DENSE_IOA_MIN_SIZE = 1024;
+
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t Hash(uint64_t h, const std::string& s)
+    {
+        for (auto c: s) {
+            h = (h ^ static_cast<uint8_t>(c)) * FNV_PRIME;
+        }
+        return h;
+    }
+
+    //! FNV-1a hash of device and control names separated by '/'
+    uint64_t Hash(const std::string& device, const std::string& control)
+    {
+        return Hash((Hash(FNV_OFFSET_BASIS, device) ^ '/') * FNV_PRIME, control);
+    }
+
+    size_t Hash(uint32_t ioa)
+    {
+        return ioa * 2654435761U;
+    }
+
+    //! Power of two table size with load factor not more than 0.5
+    size_t GetTableSize(size_t count)
+    {
+        size_t size = 16;
+        while (size < count * 2) {
+            size <<= 1;
+        }
+        return size;
+    }
+}
+
+TPointIndex::TPointIndex(const TDeviceConfig& devices)
+{
+    for (const auto& device: devices) {
+        for (const auto& control: device.second) {
+            Objects.push_back(control.second);
+            Controls.push_back({device.first, control.first});
+        }
+    }
+
+    size_t controlsCount = 0;
+    uint32_t maxIoa = 0;
+    for (size_t i = 0; i < Objects.size(); ++i) {
+        if (i == 0 || Controls[i].Device != Controls[i - 1].Device || Controls[i].Control != Controls[i - 1].Control) {
+            ++controlsCount;
+        }
+        maxIoa = std::max(maxIoa, Objects[i].Address);
+    }
+
+    ControlTable.assign(GetTableSize(controlsCount), TControlEntry{0, 0, 0});
+    ControlMask = ControlTable.size() - 1;
+    size_t first = 0;
+    for (size_t i = 1; i <= Objects.size(); ++i) {
+        if (i == Objects.size() || Controls[i].Device != Controls[first].Device ||
+            Controls[i].Control != Controls[first].Control)
+        {
+            AddControl(Hash(Controls[first].Device, Controls[first].Control), first, i - first);
+            first = i;
+        }
+    }
+
+    if (maxIoa < std::max(DENSE_IOA_MIN_SIZE, Objects.size() * DENSE_IOA_FACTOR)) {
+        DenseIoaTable.assign(maxIoa + 1, NO_IOA_SLOT);
+        IoaMask = 0;
+    } else {
+        IoaTable.assign(GetTableSize(Objects.size()), TIoaEntry{0, NO_IOA_SLOT});
+        IoaMask = IoaTable.size() - 1;
+    }
+    for (size_t i = 0; i < Objects.size(); ++i) {
+        AddIoa(Objects[i].Address, i);
+    }
+}
+
+void TPointIndex::AddControl(uint64_t hash, uint32_t first, uint32_t count)
+{
+    for (auto i = hash & ControlMask;; i = (i + 1) & ControlMask) {
+        if (ControlTable[i].Count == 0) {
+            ControlTable[i] = {hash, first, count};
+            return;
+        }
+    }
+}
+
+void TPointIndex::AddIoa(uint32_t ioa, uint32_t slot)
+{
+    if (!DenseIoaTable.empty()) {
+        DenseIoaTable[ioa] = slot;
+        return;
+    }
+    for (auto i = Hash(ioa) & IoaMask;; i = (i + 1) & IoaMask) {
+        if (IoaTable[i].Slot == NO_IOA_SLOT || IoaTable[i].Ioa == ioa) {
+            IoaTable[i] = {ioa, slot};
+            return;
+        }
+    }
+}
+
+TPointIndex::TRange TPointIndex::Find(const std::string& device, const std::string& control) const
+{
+    auto hash = Hash(device, control);
+    for (auto i = hash & ControlMask;; i = (i + 1) & ControlMask) {
+        const auto& entry = ControlTable[i];
+        if (entry.Count == 0) {
+            return {0, 0};
+        }
+        if (entry.Hash == hash && Controls[entry.First].Control == control && Controls[entry.First].Device == device)
+        {
+            return {entry.First, entry.First + entry.Count};
+        }
+    }
+}
+
+size_t TPointIndex::Find(uint32_t ioa) const
+{
+    if (!DenseIoaTable.empty()) {
+        if (ioa < DenseIoaTable.size() && DenseIoaTable[ioa] != NO_IOA_SLOT) {
+            return DenseIoaTable[ioa];
+        }
+        return NO_SLOT;
+    }
+    for (auto i = Hash(ioa) & IoaMask;; i = (i + 1) & IoaMask) {
+        const auto& entry = IoaTable[i];
+        if (entry.Slot == NO_IOA_SLOT) {
+            return NO_SLOT;
+        }
+        if (entry.Ioa == ioa) {
+            return entry.Slot;
+        }
+    }
+}
+
+size_t TPointIndex::Size() const
+{
+    return Objects.size();
+}
+
+const TIecInformationObject& TPointIndex::GetObject(size_t slot) const
+{
+    return Objects[slot];
+}
+
+const TControlDesc& TPointIndex::GetControl(size_t slot) const
+{
+    return Controls[slot];
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "gateway.h"
+
+/**
+ * @brief Immutable index of configured information objects built once at startup.
+ *        Every information object gets a slot. Slots are numbered in configuration order,
+ *        all slots of one MQTT control are adjacent.
+ *        MQTT control to slots lookup uses open-addressing hash table.
+ *        IOA to slot lookup uses direct table if addresses are dense enough, otherwise open-addressing hash table.
+ *        The class is threadsafe for reading.
+ */
+class TPointIndex
+{
+public:
+    //! Range of slots [First, Last)
+    struct TRange
+    {
+        size_t First;
+        size_t Last;
+
+        bool IsEmpty() const
+        {
+            return First == Last;
+        }
+    };
+
+    static const size_t NO_SLOT;
+
+    TPointIndex(const TDeviceConfig& devices);
+
+    //! Get slots of MQTT control. Returns empty range if the control is not configured
+    TRange Find(const std::string& device, const std::string& control) const;
+
+    //! Get slot of information object. Returns NO_SLOT if the address is not configured
+    size_t Find(uint32_t ioa) const;
+
+    size_t Size() const;
+
+    const TIecInformationObject& GetObject(size_t slot) const;
+    const TControlDesc& GetControl(size_t slot) const;
+
+private:
+    struct TControlEntry
+    {
+        uint64_t Hash;
+        uint32_t First;
+        uint32_t Count; // 0 for empty entry
+    };
+
+    struct TIoaEntry
+    {
+        uint32_t Ioa;
+        uint32_t Slot; // NO_IOA_SLOT for empty entry
+    };
+
+    std::vector<TIecInformationObject> Objects;
+    std::vector<TControlDesc> Controls;
+
+    std::vector<TControlEntry> ControlTable;
+    size_t ControlMask;
+
+    std::vector<uint32_t> DenseIoaTable; // Maps IOA to slot if addresses are dense
+    std::vector<TIoaEntry> IoaTable;     // Open-addressing table if addresses are sparse
+    size_t IoaMask;
+
+    void AddControl(uint64_t hash, uint32_t first, uint32_t count);
+    void AddIoa(uint32_t ioa, uint32_t slot);
+};
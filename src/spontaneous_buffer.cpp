@@ -0,0 +1,63 @@
+#include "spontaneous_buffer.h"
+
+IEC104::TSpontaneousBuffer::TSpontaneousBuffer(bool keepEventsHistory)
+    : KeepEventsHistory(keepEventsHistory),
+      Size(0)
+{}
+
+template<class T>
+void IEC104::TSpontaneousBuffer::Add(std::vector<T>& pending,
+                                     TPositions& positions,
+                                     const std::vector<T>& objs,
+                                     bool keepAll)
+{
+    for (const auto& obj: objs) {
+        if (!keepAll) {
+            auto it = positions.find(obj.Address);
+            if (it != positions.end()) {
+                pending[it->second] = obj;
+                continue;
+            }
+            positions.emplace(obj.Address, pending.size());
+        }
+        pending.push_back(obj);
+        ++Size;
+    }
+}
+
+size_t IEC104::TSpontaneousBuffer::Add(const TInformationObjects& objs)
+{
+    Add(Pending.SinglePoint, Positions[0], objs.SinglePoint, false);
+    Add(Pending.MeasuredValueShort, Positions[1], objs.MeasuredValueShort, false);
+    Add(Pending.MeasuredValueScaled, Positions[2], objs.MeasuredValueScaled, false);
+    Add(Pending.DoublePoint, Positions[3], objs.DoublePoint, false);
+    Add(Pending.MeasuredValueNormalized, Positions[4], objs.MeasuredValueNormalized, false);
+    Add(Pending.BitString, Positions[5], objs.BitString, false);
+    Add(Pending.StepPosition, Positions[6], objs.StepPosition, false);
+    Add(Pending.SinglePointWithTimestamp, Positions[7], objs.SinglePointWithTimestamp, KeepEventsHistory);
+    Add(Pending.MeasuredValueShortWithTimestamp,
+        Positions[8],
+        objs.MeasuredValueShortWithTimestamp,
+        KeepEventsHistory);
+    Add(Pending.MeasuredValueScaledWithTimestamp,
+        Positions[9],
+        objs.MeasuredValueScaledWithTimestamp,
+        KeepEventsHistory);
+    return Size;
+}
+
+IEC104::TInformationObjects IEC104::TSpontaneousBuffer::Take()
+{
+    TInformationObjects res;
+    std::swap(res, Pending);
+    for (auto& positions: Positions) {
+        positions.clear();
+    }
+    Size = 0;
+    return res;
+}
+
+bool IEC104::TSpontaneousBuffer::IsEmpty() const
+{
+    return Size == 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <unordered_map>
+
+#include "IEC104Server.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Accumulates spontaneous changes of information objects until they are flushed.
+     *        Only the latest value of an information object is kept,
+     *        unless it has a timestamp and events history must be preserved.
+     *        The class is not threadsafe.
+     */
+    class TSpontaneousBuffer
+    {
+    public:
+        TSpontaneousBuffer(bool keepEventsHistory);
+
+        //! Add changes to the buffer. Returns number of pending information objects
+        size_t Add(const TInformationObjects& objs);
+
+        //! Return all pending information objects and clear the buffer
+        TInformationObjects Take();
+
+        bool IsEmpty() const;
+
+    private:
+        bool KeepEventsHistory;
+        size_t Size;
+        TInformationObjects Pending;
+        typedef std::unordered_map<uint32_t, size_t> TPositions; // Maps information object address to index in Pending
+
+        //! Positions of every type of information objects. An address can be pending with different types
+        //! after reconfiguration, so positions of one type must not be used for vectors of other types
+        std::array<TPositions, 10> Positions;
+
+        template<class T>
+        void Add(std::vector<T>& pending, TPositions& positions, const std::vector<T>& objs, bool keepAll);
+    };
+}
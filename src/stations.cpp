@@ -0,0 +1,96 @@
+#include "stations.h"
+
+#include <algorithm>
+
+namespace
+{
+    //! Append objects of one type to objects of their stations
+    template<class T>
+    void SplitVector(const IEC104::TStations& stations,
+                     const std::vector<T>& objs,
+                     std::vector<T> IEC104::TInformationObjects::*member,
+                     std::vector<std::pair<uint16_t, IEC104::TInformationObjects>>& res,
+                     std::vector<bool>& used)
+    {
+        const auto& commonAddresses = stations.GetCommonAddresses();
+        for (const auto& obj: objs) {
+            auto commonAddress = stations.GetCommonAddress(obj.Address);
+            auto index = std::lower_bound(commonAddresses.begin(), commonAddresses.end(), commonAddress) -
+                         commonAddresses.begin();
+            (res[index].second.*member).push_back(obj);
+            used[index] = true;
+        }
+    }
+}
+
+IEC104::TStations::TStations(uint16_t defaultAddress, const TCommonAddresses& addresses)
+    : DefaultAddress(defaultAddress)
+{
+    CommonAddresses.push_back(defaultAddress);
+    for (const auto& address: addresses) {
+        if (address.second != defaultAddress) {
+            Addresses.insert(address);
+            CommonAddresses.push_back(address.second);
+        }
+    }
+    std::sort(CommonAddresses.begin(), CommonAddresses.end());
+    CommonAddresses.erase(std::unique(CommonAddresses.begin(), CommonAddresses.end()), CommonAddresses.end());
+}
+
+uint16_t IEC104::TStations::GetCommonAddress(uint32_t address) const
+{
+    auto it = Addresses.find(address);
+    return (it == Addresses.end()) ? DefaultAddress : it->second;
+}
+
+const std::vector<uint16_t>& IEC104::TStations::GetCommonAddresses() const
+{
+    return CommonAddresses;
+}
+
+bool IEC104::TStations::HasStation(uint16_t commonAddress) const
+{
+    return std::binary_search(CommonAddresses.begin(), CommonAddresses.end(), commonAddress);
+}
+
+std::vector<std::pair<uint16_t, IEC104::TInformationObjects>> IEC104::TStations::SplitObjects(
+    const TInformationObjects& objs) const
+{
+    std::vector<std::pair<uint16_t, TInformationObjects>> res(CommonAddresses.size());
+    std::vector<bool> used(CommonAddresses.size(), false);
+    for (size_t i = 0; i < CommonAddresses.size(); ++i) {
+        res[i].first = CommonAddresses[i];
+    }
+    SplitVector(*this, objs.SinglePoint, &TInformationObjects::SinglePoint, res, used);
+    SplitVector(*this, objs.MeasuredValueShort, &TInformationObjects::MeasuredValueShort, res, used);
+    SplitVector(*this, objs.MeasuredValueScaled, &TInformationObjects::MeasuredValueScaled, res, used);
+    SplitVector(*this, objs.DoublePoint, &TInformationObjects::DoublePoint, res, used);
+    SplitVector(*this, objs.MeasuredValueNormalized, &TInformationObjects::MeasuredValueNormalized, res, used);
+    SplitVector(*this, objs.BitString, &TInformationObjects::BitString, res, used);
+    SplitVector(*this, objs.StepPosition, &TInformationObjects::StepPosition, res, used);
+    SplitVector(*this, objs.SinglePointWithTimestamp, &TInformationObjects::SinglePointWithTimestamp, res, used);
+    SplitVector(*this,
+                objs.MeasuredValueShortWithTimestamp,
+                &TInformationObjects::MeasuredValueShortWithTimestamp,
+                res,
+                used);
+    SplitVector(*this,
+                objs.MeasuredValueScaledWithTimestamp,
+                &TInformationObjects::MeasuredValueScaledWithTimestamp,
+                res,
+                used);
+    SplitVector(*this, objs.IntegratedTotals, &TInformationObjects::IntegratedTotals, res, used);
+
+    // Only stations with objects are returned
+    size_t count = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+        if (used[i]) {
+            if (count != i) {
+                res[count] = std::move(res[i]);
+            }
+            ++count;
+        }
+    }
+    res.resize(count);
+    return res;
+}
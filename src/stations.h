@@ -0,0 +1,63 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "information_object_encoder.h"
+
+namespace IEC104
+{
+    /**
+     * @brief Stations (common addresses) served by one server. Addresses of information objects are unique
+     *        across all stations, so a station of an object is found by its address. Objects which are not listed
+     *        in common addresses belong to the default station. The class is not threadsafe.
+     */
+    class TStations
+    {
+    public:
+        TStations(uint16_t defaultAddress, const TCommonAddresses& addresses);
+
+        //! Common address of the station the information object belongs to
+        uint16_t GetCommonAddress(uint32_t address) const;
+
+        //! Common addresses of all stations in ascending order
+        const std::vector<uint16_t>& GetCommonAddresses() const;
+
+        //! The server has a station with the common address
+        bool HasStation(uint16_t commonAddress) const;
+
+        /**
+         * @brief Split information objects by stations and call fn(commonAddress, objs) for every station
+         *        with objects. If there is only one station, objs are passed as is without copying
+         */
+        template<class TFn> void Split(const TInformationObjects& objs, TFn&& fn) const
+        {
+            if (CommonAddresses.size() == 1) {
+                fn(DefaultAddress, objs);
+                return;
+            }
+            for (const auto& station: SplitObjects(objs)) {
+                fn(station.first, station.second);
+            }
+        }
+
+        //! Pack information objects into ASDUs with common addresses of their stations and pass them to sendFn
+        template<class TSendFn>
+        void Send(CS101_AppLayerParameters appLayerParameters,
+                  CS101_CauseOfTransmission cot,
+                  const TInformationObjects& objs,
+                  TSendFn&& sendFn) const
+        {
+            Split(objs, [&](uint16_t commonAddress, const TInformationObjects& stationObjs) {
+                IEC104::Send(appLayerParameters, commonAddress, cot, stationObjs, sendFn);
+            });
+        }
+
+    private:
+        uint16_t DefaultAddress;
+        TCommonAddresses Addresses;
+        std::vector<uint16_t> CommonAddresses;
+
+        std::vector<std::pair<uint16_t, TInformationObjects>> SplitObjects(const TInformationObjects& objs) const;
+    };
+}
@@ -0,0 +1,48 @@
+#include "statistics.h"
+
+TStatistics Statistics;
+
+namespace
+{
+    std::atomic<size_t> NextShard(0);
+
+    size_t GetShardIndex()
+    {
+        thread_local size_t shard = NextShard.fetch_add(1, std::memory_order_relaxed) % TCounter::SHARDS_COUNT;
+        return shard;
+    }
+}
+
+TCounter::TCounter()
+{
+    for (auto& shard: Shards) {
+        shard.Value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void TCounter::Add(uint64_t n)
+{
+    Shards[GetShardIndex()].Value.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t TCounter::Get() const
+{
+    uint64_t res = 0;
+    for (const auto& shard: Shards) {
+        res += shard.Value.load(std::memory_order_relaxed);
+    }
+    return res;
+}
+
+TGauge::TGauge(): Value(0)
+{}
+
+void TGauge::Add(int64_t delta)
+{
+    Value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+int64_t TGauge::Get() const
+{
+    return Value.load(std::memory_order_relaxed);
+}
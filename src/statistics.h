@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "latency_histogram.h"
+
+/**
+ * @brief Monotonic counter for hot paths. Threads increment different cache line aligned shards
+ *        with relaxed atomics, so concurrent increments don't contend. Reading sums all shards.
+ */
+class TCounter
+{
+public:
+    static const size_t SHARDS_COUNT = 8;
+
+    TCounter();
+
+    void Add(uint64_t n = 1);
+
+    uint64_t Get() const;
+
+private:
+    struct alignas(64) TShard
+    {
+        std::atomic<uint64_t> Value;
+    };
+
+    TShard Shards[SHARDS_COUNT];
+};
+
+//! Current value of some quantity, e.g. number of connections
+class TGauge
+{
+public:
+    TGauge();
+
+    void Add(int64_t delta);
+
+    int64_t Get() const;
+
+private:
+    std::atomic<int64_t> Value;
+};
+
+//! Runtime statistics of the gateway
+struct TStatistics
+{
+    TCounter MqttChanges;           //! Changes of configured MQTT controls
+    TCounter FilteredChanges;       //! Changes suppressed by deadband or send interval
+    TCounter ConversionErrors;      //! MQTT values which can't be converted to information objects
+    TCounter SpontaneousAsdus;      //! ASDUs enqueued with spontaneous cause of transmission
+    TCounter SpontaneousObjects;    //! Information objects enqueued with spontaneous cause of transmission
+    TCounter Interrogations;        //! Station and group interrogations
+    TCounter CounterInterrogations; //! Counter interrogation commands
+    TCounter CommandsSucceeded;     //! Commands with positive confirmation
+    TCounter CommandsFailed;        //! Commands with negative confirmation returned by handler
+    TCounter CommandsRejected;      //! Commands rejected because of pending commands limit or closed connection
+    TCounter SnapshotDrops;         //! ASDUs of activation snapshot dropped because of full connection queue
+    TCounter QueueDrops;            //! ASDUs pushed out of full queues of redundancy groups
+    TCounter JournalDrops;          //! Events dropped because of events journal overflow
+    TCounter ReplayedEvents;        //! Events replayed from events journal
+    TGauge ConnectedMasters;        //! Open IEC connections
+    TLatencyHistogram InterrogationDuration;
+    TLatencyHistogram CommandLatency; //! Time from command reception to confirmation
+};
+
+extern TStatistics Statistics;
@@ -0,0 +1,108 @@
+#include "statistics_publisher.h"
+
+#include "log.h"
+#include "statistics.h"
+
+using namespace WBMQTT;
+
+#define LOG(logger) ::logger.Log() << "[stats] "
+
+const char* const STATISTICS_DEVICE_ID = "wb-mqtt-iec104";
+
+namespace
+{
+    //! Published statistics in order of controls
+    std::vector<std::pair<std::string, double>> GetValues()
+    {
+        return {{"mqtt_changes", double(Statistics.MqttChanges.Get())},
+                {"filtered_changes", double(Statistics.FilteredChanges.Get())},
+                {"conversion_errors", double(Statistics.ConversionErrors.Get())},
+                {"spontaneous_asdus", double(Statistics.SpontaneousAsdus.Get())},
+                {"spontaneous_objects", double(Statistics.SpontaneousObjects.Get())},
+                {"interrogations", double(Statistics.Interrogations.Get())},
+                {"interrogation_p50_us", double(Statistics.InterrogationDuration.GetPercentile(50).count())},
+                {"interrogation_max_us", double(Statistics.InterrogationDuration.GetMax().count())},
+                {"counter_interrogations", double(Statistics.CounterInterrogations.Get())},
+                {"commands_succeeded", double(Statistics.CommandsSucceeded.Get())},
+                {"commands_failed", double(Statistics.CommandsFailed.Get())},
+                {"commands_rejected", double(Statistics.CommandsRejected.Get())},
+                {"command_p50_us", double(Statistics.CommandLatency.GetPercentile(50).count())},
+                {"command_p99_us", double(Statistics.CommandLatency.GetPercentile(99).count())},
+                {"snapshot_drops", double(Statistics.SnapshotDrops.Get())},
+                {"queue_drops", double(Statistics.QueueDrops.Get())},
+                {"journal_drops", double(Statistics.JournalDrops.Get())},
+                {"replayed_events", double(Statistics.ReplayedEvents.Get())},
+                {"connected_masters", double(Statistics.ConnectedMasters.Get())}};
+    }
+}
+
+TStatisticsPublisher::TStatisticsPublisher(PDeviceDriver driver, std::chrono::milliseconds interval)
+    : Driver(driver),
+      Interval(interval),
+      Stopped(false)
+{
+    auto tx = Driver->BeginTx();
+    auto device = tx->CreateDevice(TLocalDeviceArgs{}
+                                       .SetId(STATISTICS_DEVICE_ID)
+                                       .SetTitle("IEC 60870-5-104 gateway statistics")
+                                       .SetIsVirtual(true)
+                                       .SetDoLoadPrevious(false))
+                      .GetValue();
+    int order = 1;
+    for (const auto& value: GetValues()) {
+        Controls.push_back(device
+                               ->CreateControl(tx,
+                                               TControlArgs{}
+                                                   .SetId(value.first)
+                                                   .SetType("value")
+                                                   .SetReadonly(true)
+                                                   .SetOrder(order++)
+                                                   .SetValue(value.second))
+                               .GetValue());
+    }
+    tx->End();
+    Thread = std::thread([this]() {
+        SetThreadName("iec104 stats");
+        std::unique_lock<std::mutex> lk(Mutex);
+        while (!Cv.wait_for(lk, Interval, [this]() { return Stopped; })) {
+            Publish();
+        }
+    });
+}
+
+TStatisticsPublisher::~TStatisticsPublisher()
+{
+    Stop();
+}
+
+void TStatisticsPublisher::Stop()
+{
+    {
+        std::unique_lock<std::mutex> lk(Mutex);
+        if (Stopped) {
+            return;
+        }
+        Stopped = true;
+    }
+    Cv.notify_all();
+    Thread.join();
+    try {
+        auto tx = Driver->BeginTx();
+        tx->RemoveDeviceById(STATISTICS_DEVICE_ID).Sync();
+    } catch (const std::exception& e) {
+        LOG(Warn) << "Can't remove statistics device: " << e.what();
+    }
+}
+
+void TStatisticsPublisher::Publish()
+{
+    try {
+        auto tx = Driver->BeginTx();
+        auto values = GetValues();
+        for (size_t i = 0; i < values.size(); ++i) {
+            Controls[i]->SetValue(tx, values[i].second);
+        }
+    } catch (const std::exception& e) {
+        LOG(Warn) << "Can't publish statistics: " << e.what();
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <wblib/wbmqtt.h>
+
+//! MQTT device of statistics. It has the same id as MQTT driver of the gateway
+extern const char* const STATISTICS_DEVICE_ID;
+
+/**
+ * @brief Periodically publishes runtime statistics as controls of wb-mqtt-iec104 MQTT device
+ */
+class TStatisticsPublisher
+{
+public:
+    TStatisticsPublisher(WBMQTT::PDeviceDriver driver, std::chrono::milliseconds interval);
+    ~TStatisticsPublisher();
+
+    //! Stop publishing and remove the device. Must be called before stopping the driver
+    void Stop();
+
+private:
+    WBMQTT::PDeviceDriver Driver;
+    std::chrono::milliseconds Interval;
+    std::vector<WBMQTT::PControl> Controls;
+    std::mutex Mutex;
+    std::condition_variable Cv;
+    std::thread Thread;
+    bool Stopped;
+
+    void Publish();
+};
@@ -0,0 +1,51 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+TTimerWheel::TTimerWheel(size_t bucketsCount, std::chrono::steady_clock::duration tick, const TTimePoint& start)
+    : Buckets(bucketsCount),
+      Tick(tick),
+      Time(start),
+      Current(0),
+      Count(0)
+{
+    if (bucketsCount == 0 || tick <= std::chrono::steady_clock::duration::zero()) {
+        throw std::invalid_argument("Timer wheel must have buckets and positive tick");
+    }
+}
+
+void TTimerWheel::Add(size_t id, const TTimePoint& deadline)
+{
+    size_t ticks = 0;
+    if (deadline > Time) {
+        ticks = std::min<size_t>((deadline - Time) / Tick, Buckets.size() - 1);
+    }
+    Buckets[(Current + ticks) % Buckets.size()].push_back({id, deadline});
+    ++Count;
+}
+
+void TTimerWheel::Advance(const TTimePoint& now, std::vector<size_t>& expired)
+{
+    expired.clear();
+    while (Time + Tick <= now) {
+        Passed.clear();
+        Passed.swap(Buckets[Current]);
+        Count -= Passed.size();
+        Current = (Current + 1) % Buckets.size();
+        Time += Tick;
+        for (const auto& timer: Passed) {
+            if (timer.Deadline <= now) {
+                expired.push_back(timer.Id);
+            } else {
+                // Timer from beyond one turn of the wheel
+                Add(timer.Id, timer.Deadline);
+            }
+        }
+    }
+}
+
+size_t TTimerWheel::Size() const
+{
+    return Count;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+/**
+ * @brief Hashed timer wheel for a lot of timers with the same resolution.
+ *        Timers are put into buckets by deadline, so adding of a timer costs O(1) and advancing of the wheel
+ *        touches only timers of passed buckets. Timers with deadline beyond one turn of the wheel are kept
+ *        in the last bucket and rescheduled when it is passed. Timers fire not later than one tick after deadline.
+ *        Timers can't be cancelled, owner must check if an expired timer is still actual.
+ *        The class is not threadsafe.
+ */
+class TTimerWheel
+{
+public:
+    typedef std::chrono::steady_clock::time_point TTimePoint;
+
+    TTimerWheel(size_t bucketsCount, std::chrono::steady_clock::duration tick, const TTimePoint& start);
+
+    //! Add timer with deadline. The same id can be added several times
+    void Add(size_t id, const TTimePoint& deadline);
+
+    //! Move the wheel to time now and put ids of expired timers to expired. The vector is cleared before,
+    //! so a caller can reuse it between calls without allocations
+    void Advance(const TTimePoint& now, std::vector<size_t>& expired);
+
+    //! Number of timers in the wheel
+    size_t Size() const;
+
+private:
+    struct TTimer
+    {
+        size_t Id;
+        TTimePoint Deadline;
+    };
+
+    std::vector<std::vector<TTimer>> Buckets;
+    std::vector<TTimer> Passed; // Timers of passed bucket. Its buffer is swapped with buckets, so it is reused
+    std::chrono::steady_clock::duration Tick;
+    TTimePoint Time; // Start of current bucket's interval
+    size_t Current;
+    size_t Count;
+};
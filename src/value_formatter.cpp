@@ -0,0 +1,39 @@
+#include "value_formatter.h"
+
+#include <charconv>
+
+#if !defined(__cpp_lib_to_chars)
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+size_t ValueFormatter::FormatInt(int64_t value, char* buf) noexcept
+{
+    return std::to_chars(buf, buf + MAX_SIZE, value).ptr - buf;
+}
+
+size_t ValueFormatter::FormatFloat(float value, char* buf) noexcept
+{
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(buf, buf + MAX_SIZE, value).ptr - buf;
+#else
+    // Floating point std::to_chars is not available, the shortest representation is searched with snprintf
+    // in "C" locale. 9 significant digits are always enough for float
+    static const locale_t cLocale = newlocale(LC_ALL_MASK, "C", nullptr);
+    auto oldLocale = uselocale(cLocale);
+    char tmp[MAX_SIZE + 1];
+    int size = 0;
+    for (int precision = 6; precision <= 9; ++precision) {
+        size = snprintf(tmp, sizeof(tmp), "%.*g", precision, value);
+        if (strtof_l(tmp, nullptr, cLocale) == value) {
+            break;
+        }
+    }
+    uselocale(oldLocale);
+    for (int i = 0; i < size; ++i) {
+        buf[i] = tmp[i];
+    }
+    return size;
+#endif
+}
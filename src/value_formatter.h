@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Locale independent formatting of values for MQTT controls without memory allocations.
+ *        Numbers are written to a caller's buffer of at least MAX_SIZE chars without terminating zero.
+ */
+namespace ValueFormatter
+{
+    //! Enough for any formatted number
+    const size_t MAX_SIZE = 24;
+
+    //! Returns number of written chars
+    size_t FormatInt(int64_t value, char* buf) noexcept;
+
+    //! Write the shortest representation which is parsed back to the same float. Returns number of written chars
+    size_t FormatFloat(float value, char* buf) noexcept;
+}
@@ -0,0 +1,156 @@
+#include "value_parser.h"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+#if !defined(__cpp_lib_to_chars)
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#endif
+
+namespace
+{
+    bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    //! Get number's bounds without spaces and leading '+'. Returns false if the value is empty
+    bool Trim(const std::string& value, const char*& first, const char*& last)
+    {
+        first = value.data();
+        last = value.data() + value.size();
+        while (first != last && IsSpace(*first)) {
+            ++first;
+        }
+        while (first != last && IsSpace(*(last - 1))) {
+            --last;
+        }
+        // from_chars doesn't accept '+', it is kept if it isn't followed by a number to fail parsing
+        if (last - first > 1 && *first == '+' && first[1] != '-') {
+            ++first;
+        }
+        return first != last;
+    }
+
+    //! res is not changed on error
+    TParseResult ParseNumber(const char* first, const char* last, double& res)
+    {
+#if defined(__cpp_lib_to_chars)
+        double d;
+        auto r = std::from_chars(first, last, d);
+        if (r.ec == std::errc::result_out_of_range) {
+            return TParseResult::OutOfRange;
+        }
+        if (r.ec != std::errc() || r.ptr != last) {
+            return TParseResult::Invalid;
+        }
+        res = d;
+        return TParseResult::Ok;
+#else
+        // Floating point std::from_chars is not available, strtod with "C" locale is the closest replacement.
+        // Hexadecimal numbers are rejected as from_chars does
+        static const locale_t cLocale = newlocale(LC_ALL_MASK, "C", nullptr);
+        if (last - first > 1 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+            return TParseResult::Invalid;
+        }
+        char* end;
+        errno = 0;
+        auto d = strtod_l(first, &end, cLocale);
+        if (end != last || end == first) {
+            return TParseResult::Invalid;
+        }
+        if (errno == ERANGE) {
+            return TParseResult::OutOfRange;
+        }
+        res = d;
+        return TParseResult::Ok;
+#endif
+    }
+}
+
+TParseResult ValueParser::ParseBool(const std::string& value, bool& res) noexcept
+{
+    const char* first;
+    const char* last;
+    if (!Trim(value, first, last)) {
+        return TParseResult::Empty;
+    }
+    if (last - first != 1 || (*first != '0' && *first != '1')) {
+        return TParseResult::Invalid;
+    }
+    res = (*first == '1');
+    return TParseResult::Ok;
+}
+
+TParseResult ValueParser::ParseInt(const std::string& value, int32_t& res) noexcept
+{
+    const char* first;
+    const char* last;
+    if (!Trim(value, first, last)) {
+        return TParseResult::Empty;
+    }
+    int32_t i;
+    auto r = std::from_chars(first, last, i);
+    if (r.ec == std::errc() && r.ptr == last) {
+        res = i;
+        return TParseResult::Ok;
+    }
+    if (r.ec == std::errc::result_out_of_range) {
+        return TParseResult::OutOfRange;
+    }
+    // Fractional or exponential notation
+    double d;
+    auto dr = ParseNumber(first, last, d);
+    if (dr != TParseResult::Ok) {
+        return dr;
+    }
+    if (!std::isfinite(d) || d <= std::numeric_limits<int32_t>::min() - 1.0 ||
+        d >= std::numeric_limits<int32_t>::max() + 1.0)
+    {
+        return TParseResult::OutOfRange;
+    }
+    res = static_cast<int32_t>(d);
+    return TParseResult::Ok;
+}
+
+TParseResult ValueParser::ParseFloat(const std::string& value, float& res) noexcept
+{
+    double d;
+    auto r = ParseDouble(value, d);
+    if (r != TParseResult::Ok) {
+        return r;
+    }
+    if (std::isfinite(d) && std::fabs(d) > std::numeric_limits<float>::max()) {
+        return TParseResult::OutOfRange;
+    }
+    res = static_cast<float>(d);
+    return TParseResult::Ok;
+}
+
+TParseResult ValueParser::ParseDouble(const std::string& value, double& res) noexcept
+{
+    const char* first;
+    const char* last;
+    if (!Trim(value, first, last)) {
+        return TParseResult::Empty;
+    }
+    return ParseNumber(first, last, res);
+}
+
+const char* ValueParser::GetDescription(TParseResult result) noexcept
+{
+    switch (result) {
+        case TParseResult::Ok:
+            return "ok";
+        case TParseResult::Empty:
+            return "empty value";
+        case TParseResult::Invalid:
+            return "invalid format";
+        case TParseResult::OutOfRange:
+            return "out of range";
+    }
+    return "unknown error";
+}
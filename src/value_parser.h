@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//! Result of parsing of MQTT control value
+enum class TParseResult
+{
+    Ok,
+    Empty,     //! Value is empty or contains only spaces
+    Invalid,   //! Value is not a number, or not 0/1 for boolean
+    OutOfRange //! Number doesn't fit into the type
+};
+
+/**
+ * @brief Locale independent parsing of MQTT control values without exceptions and memory allocations.
+ *        Leading and trailing spaces are skipped, leading '+' is allowed, the rest of the string must be a number.
+ *        The result is not changed if parsing fails.
+ */
+namespace ValueParser
+{
+    //! Parse "0" or "1"
+    TParseResult ParseBool(const std::string& value, bool& res) noexcept;
+
+    //! Parse integer. Fractional numbers are truncated toward zero
+    TParseResult ParseInt(const std::string& value, int32_t& res) noexcept;
+
+    TParseResult ParseFloat(const std::string& value, float& res) noexcept;
+
+    TParseResult ParseDouble(const std::string& value, double& res) noexcept;
+
+    const char* GetDescription(TParseResult result) noexcept;
+}
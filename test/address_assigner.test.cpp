@@ -0,0 +1,33 @@
+#include "address_assigner.h"
+
+#include <gtest/gtest.h>
+#include <unordered_set>
+
+TEST(TAddressAssignerTest, Collisions)
+{
+    uint32_t address = TAddressAssigner().GetAddress("device/control");
+    ASSERT_NE(address, 0);
+
+    // Used address is skipped with fixed step
+    TAddressAssigner assigner;
+    assigner.Reserve(address);
+    ASSERT_TRUE(assigner.IsUsed(address));
+    ASSERT_EQ(assigner.GetAddress("device/control"), (address + 7079) & 0xFFFFFF);
+    ASSERT_EQ(assigner.GetAddress("device/control"), (address + 2 * 7079) & 0xFFFFFF);
+
+    // Addresses out of range are ignored
+    assigner.Reserve(0x1000000);
+    ASSERT_FALSE(assigner.IsUsed(0x1000000));
+    ASSERT_TRUE(assigner.IsUsed(0));
+}
+
+TEST(TAddressAssignerTest, Uniqueness)
+{
+    TAddressAssigner assigner;
+    std::unordered_set<uint32_t> addresses;
+    for (size_t i = 0; i < 10000; ++i) {
+        auto address = assigner.GetAddress("device/control");
+        ASSERT_NE(address, 0);
+        ASSERT_TRUE(addresses.insert(address).second);
+    }
+}
@@ -0,0 +1,61 @@
+#include "command_selections.h"
+
+#include <gtest/gtest.h>
+
+using std::chrono::milliseconds;
+
+namespace
+{
+    const auto START = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+}
+
+TEST(TCommandSelectionsTest, SelectAndRelease)
+{
+    IEC104::TCommandSelections selections(milliseconds(1000));
+
+    ASSERT_TRUE(selections.IsAvailable(1, 10, START));
+    selections.Select(1, 10, START);
+
+    // Selected object is reserved for its connection
+    ASSERT_TRUE(selections.IsAvailable(1, 10, START));
+    ASSERT_FALSE(selections.IsAvailable(2, 10, START + milliseconds(999)));
+    ASSERT_TRUE(selections.IsAvailable(2, 11, START));
+
+    // Only owner can release the selection
+    selections.Release(2, 10);
+    ASSERT_FALSE(selections.IsAvailable(2, 10, START));
+    selections.Release(1, 10);
+    ASSERT_TRUE(selections.IsAvailable(2, 10, START));
+
+    selections.Select(1, 10, START);
+    selections.Select(1, 11, START);
+    selections.Select(2, 12, START);
+    selections.ReleaseAll(1);
+    ASSERT_EQ(selections.Size(), 1);
+    ASSERT_TRUE(selections.IsAvailable(2, 10, START));
+    ASSERT_FALSE(selections.IsAvailable(1, 12, START));
+}
+
+TEST(TCommandSelectionsTest, Timeouts)
+{
+    IEC104::TCommandSelections selections(milliseconds(1000), {{20, milliseconds(5000)}});
+
+    selections.Select(1, 10, START);
+    selections.Select(1, 20, START);
+    ASSERT_TRUE(selections.IsAvailable(2, 10, START + milliseconds(1000)));
+    ASSERT_FALSE(selections.IsAvailable(2, 20, START + milliseconds(1000)));
+    ASSERT_TRUE(selections.IsAvailable(2, 20, START + milliseconds(5000)));
+
+    // Expired selection is taken over by another connection
+    selections.Select(2, 10, START + milliseconds(1000));
+    ASSERT_FALSE(selections.IsAvailable(1, 10, START + milliseconds(1000)));
+
+    selections.SetTimeouts(milliseconds(100), {});
+    selections.Select(1, 30, START);
+    ASSERT_TRUE(selections.IsAvailable(2, 30, START + milliseconds(100)));
+
+    // Zero timeout never expires
+    selections.SetTimeouts(milliseconds::zero(), {});
+    selections.Select(1, 40, START);
+    ASSERT_FALSE(selections.IsAvailable(2, 40, START + std::chrono::hours(24)));
+}
@@ -1,4 +1,5 @@
 #include "config_parser.h"
+#include "statistics_publisher.h"
 
 #include <gtest/gtest.h>
 #include <vector>
@@ -46,7 +47,7 @@ TEST_F(TLoadConfigTest, bad_config)
 TEST_F(TLoadConfigTest, good)
 {
     auto c = LoadConfig(TestRootDir + "/good/wb-mqtt-iec104.conf", SchemaFile);
-    ASSERT_EQ(c.Devices.size(), 1);
+    ASSERT_EQ(c.Devices.size(), 3);
     ASSERT_EQ(c.Devices["test"].size(), 6);
     const TIecInformationObjectType types[] = {SinglePoint,
                                                MeasuredValueShort,
@@ -61,6 +62,36 @@ TEST_F(TLoadConfigTest, good)
         ASSERT_EQ(control.second.Type, types[index]) << index;
         ++index;
     }
+    ASSERT_EQ(c.Devices["types"].size(), 4);
+    ASSERT_EQ(c.Devices["types"].find("double")->second.Type, DoublePoint);
+    ASSERT_EQ(c.Devices["types"].find("normalized")->second.Type, MeasuredValueNormalized);
+    ASSERT_EQ(c.Devices["types"].find("bitstring")->second.Type, BitString);
+    ASSERT_EQ(c.Devices["types"].find("step")->second.Type, StepPosition);
+
+    // Controls inherit interrogation group of their group, 0 excludes a control from group interrogation
+    IEC104::TInterrogationGroups interrogationGroups{
+        {1, 2}, {2, 2}, {4, 16}, {5, 2}, {6, 2}, {8, 2}, {9, 2}, {10, 2}, {11, 2}};
+    ASSERT_EQ(c.Iec.InterrogationGroups, interrogationGroups);
+
+    // Only measured values without timestamp inherit cycle period of their group
+    IEC104::TCyclePeriods cyclePeriods{{2, std::chrono::milliseconds(1000)},
+                                       {3, std::chrono::milliseconds(500)},
+                                       {9, std::chrono::milliseconds(1000)}};
+    ASSERT_EQ(c.Iec.CyclePeriods, cyclePeriods);
+
+    ASSERT_EQ(c.Iec.MaxConnections, 8);
+    // Only controls of groups with own common address are listed
+    ASSERT_EQ(c.Iec.CommonAddress, 1);
+    ASSERT_EQ(c.Iec.CommonAddresses, (IEC104::TCommonAddresses{{12, 2}}));
+
+    ASSERT_EQ(c.Iec.SelectTimeout, std::chrono::milliseconds(3000));
+    ASSERT_EQ(c.Iec.SelectTimeouts, (IEC104::TSelectTimeouts{{1, std::chrono::milliseconds::zero()}}));
+    ASSERT_EQ(c.Iec.RedundancyGroups.size(), 2);
+    ASSERT_EQ(c.Iec.RedundancyGroups[0].Name, "main");
+    ASSERT_EQ(c.Iec.RedundancyGroups[0].AllowedClients,
+              (std::vector<std::string>{"192.168.1.10", "192.168.1.11"}));
+    ASSERT_EQ(c.Iec.RedundancyGroups[1].Name, "others");
+    ASSERT_TRUE(c.Iec.RedundancyGroups[1].AllowedClients.empty());
 }
 
 class TUpdateConfigTest: public Testing::TLoggedFixture
@@ -96,6 +127,10 @@ TEST_F(TUpdateConfigTest, update)
 
     device2->CreateControl(tx, TControlArgs{}.SetId("test2").SetType("value").SetReadonly(true)).GetValue();
 
+    // Statistics device of the gateway is not added to config
+    auto statistics = tx->CreateDevice(TLocalDeviceArgs{}.SetId(STATISTICS_DEVICE_ID)).GetValue();
+    statistics->CreateControl(tx, TControlArgs{}.SetId("mqtt_changes").SetType("value")).GetValue();
+
     tx->End();
 
     auto c = JSON::Parse(testRootDir + "/bad/non_unique_address.conf");
@@ -0,0 +1,127 @@
+#include "counters.h"
+
+#include <gtest/gtest.h>
+#include <map>
+
+namespace
+{
+    sCS101_AppLayerParameters AppLayerParameters = {1, 1, 2, 0, 2, 3, 249};
+
+    struct TReading
+    {
+        int32_t Value;
+        int SequenceNumber;
+        TypeID Type;
+
+        bool operator==(const TReading& other) const
+        {
+            return Value == other.Value && SequenceNumber == other.SequenceNumber && Type == other.Type;
+        }
+    };
+
+    std::map<int, TReading> Read(const IEC104::TCounters& counters, uint8_t group)
+    {
+        std::map<int, TReading> res;
+        counters.Send(&AppLayerParameters, 1, group, CS101_COT_REQUESTED_BY_GENERAL_COUNTER, [&](CS101_ASDU asdu) {
+            EXPECT_EQ(CS101_ASDU_getCOT(asdu), CS101_COT_REQUESTED_BY_GENERAL_COUNTER);
+            for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+                auto io = CS101_ASDU_getElement(asdu, i);
+                auto bcr = IntegratedTotals_getBCR((IntegratedTotals)io);
+                res[InformationObject_getObjectAddress(io)] = {BinaryCounterReading_getValue(bcr),
+                                                               BinaryCounterReading_getSequenceNumber(bcr),
+                                                               CS101_ASDU_getTypeID(asdu)};
+                InformationObject_destroy(io);
+            }
+        });
+        return res;
+    }
+}
+
+TEST(TCountersTest, FreezeAndReset)
+{
+    IEC104::TCounters counters({{1, 1}, {2, 2}});
+    counters.Update({{1, 100, false}, {2, 200, true}, {3, 300, false}});
+    ASSERT_EQ(counters.Size(), 3);
+
+    // Not frozen counters are read with current values
+    ASSERT_EQ(Read(counters, 0),
+              (std::map<int, TReading>{{1, {100, 0, M_IT_NA_1}}, {2, {200, 0, M_IT_TB_1}}, {3, {300, 0, M_IT_NA_1}}}));
+
+    counters.Freeze(0, false, std::chrono::system_clock::now());
+    counters.Update({{1, 110, false}, {2, 210, true}, {3, 310, false}});
+    ASSERT_EQ(Read(counters, 0),
+              (std::map<int, TReading>{{1, {100, 1, M_IT_NA_1}}, {2, {200, 1, M_IT_TB_1}}, {3, {300, 1, M_IT_NA_1}}}));
+
+    // Freeze with reset of group 1
+    counters.Freeze(1, true, std::chrono::system_clock::now());
+    counters.Update({{1, 125, false}});
+    ASSERT_EQ(Read(counters, 1), (std::map<int, TReading>{{1, {110, 2, M_IT_NA_1}}}));
+    counters.Freeze(1, false, std::chrono::system_clock::now());
+    ASSERT_EQ(Read(counters, 1), (std::map<int, TReading>{{1, {15, 3, M_IT_NA_1}}}));
+
+    // Reset of group 2 doesn't change frozen reading
+    counters.Reset(2);
+    counters.Update({{2, 215, true}});
+    ASSERT_EQ(Read(counters, 2), (std::map<int, TReading>{{2, {200, 2, M_IT_TB_1}}}));
+    counters.Freeze(2, false, std::chrono::system_clock::now());
+    ASSERT_EQ(Read(counters, 2), (std::map<int, TReading>{{2, {5, 3, M_IT_TB_1}}}));
+
+    ASSERT_TRUE(Read(counters, 3).empty());
+}
+
+TEST(TCountersTest, GroupRequests)
+{
+    IEC104::TCounters counters({{1, 1}, {2, 2}, {3, 3}, {4, 4}});
+    counters.Update({{1, 100, false}, {2, 200, false}, {3, 300, false}, {4, 400, false}, {5, 500, false}});
+
+    // Counter groups 1-4 (RQT 1-4) are answered with COT 38-41, general request (RQT 5) with COT 37
+    const std::map<uint8_t, CS101_CauseOfTransmission> cots{{1, CS101_COT_REQUESTED_BY_GROUP_1_COUNTER},
+                                                            {2, CS101_COT_REQUESTED_BY_GROUP_2_COUNTER},
+                                                            {3, CS101_COT_REQUESTED_BY_GROUP_3_COUNTER},
+                                                            {4, CS101_COT_REQUESTED_BY_GROUP_4_COUNTER},
+                                                            {5, CS101_COT_REQUESTED_BY_GENERAL_COUNTER}};
+    for (const auto& rqt: cots) {
+        ASSERT_EQ(IEC104::GetCounterInterrogationCot(rqt.first), rqt.second) << int(rqt.first);
+        auto group = IEC104::GetCounterGroup(rqt.first);
+        auto cot = IEC104::GetCounterInterrogationCot(rqt.first);
+        size_t count = 0;
+        counters.Send(&AppLayerParameters, 1, group, cot, [&](CS101_ASDU asdu) {
+            EXPECT_EQ(CS101_ASDU_getCOT(asdu), rqt.second) << int(rqt.first);
+            for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+                auto io = CS101_ASDU_getElement(asdu, i);
+                if (group) {
+                    EXPECT_EQ(InformationObject_getObjectAddress(io), group);
+                }
+                InformationObject_destroy(io);
+                ++count;
+            }
+        });
+        ASSERT_EQ(count, group ? 1 : 5) << int(rqt.first);
+    }
+}
+
+TEST(TCountersTest, SequenceNumberRollOver)
+{
+    IEC104::TCounters counters({});
+    counters.Update({{1, 1, false}});
+    for (int i = 0; i < 33; ++i) {
+        counters.Freeze(0, false, std::chrono::system_clock::now());
+    }
+    ASSERT_EQ(Read(counters, 0).at(1).SequenceNumber, 1);
+}
+
+TEST(TCountersTest, Reconfigure)
+{
+    IEC104::TCounters counters({{1, 1}, {3, 1}});
+    counters.Update({{1, 100, false}, {2, 200, false}, {3, 300, false}});
+    counters.Freeze(0, true, std::chrono::system_clock::now());
+
+    // Counter 1 is moved to group 2, counter 2 becomes counter with timestamp, counter 3 is removed
+    counters.Reconfigure({{1, 2}}, {{1, 110, false}, {2, 210, true}, {4, 400, false}});
+    ASSERT_EQ(counters.Size(), 3);
+    ASSERT_EQ(Read(counters, 0),
+              (std::map<int, TReading>{{1, {100, 1, M_IT_NA_1}}, {2, {210, 0, M_IT_TB_1}}, {4, {400, 0, M_IT_NA_1}}}));
+    ASSERT_TRUE(Read(counters, 1).empty());
+    counters.Freeze(2, false, std::chrono::system_clock::now());
+    ASSERT_EQ(Read(counters, 2), (std::map<int, TReading>{{1, {10, 2, M_IT_NA_1}}}));
+}
@@ -0,0 +1,54 @@
+#include "cyclic_transmission.h"
+
+#include <gtest/gtest.h>
+#include <map>
+
+namespace
+{
+    sCS101_AppLayerParameters AppLayerParameters = {1, 1, 2, 0, 2, 3, 249};
+
+    const auto START = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+
+    const IEC104::TStations STATIONS(1, {});
+
+    //! Maps address of sent information object to its type
+    std::map<int, TypeID> Send(IEC104::TCyclicTransmission& cyclic, const std::chrono::steady_clock::time_point& now)
+    {
+        std::map<int, TypeID> res;
+        cyclic.Send(&AppLayerParameters, STATIONS, now, [&](CS101_ASDU asdu) {
+            EXPECT_EQ(CS101_ASDU_getCOT(asdu), CS101_COT_PERIODIC);
+            for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+                auto io = CS101_ASDU_getElement(asdu, i);
+                res[InformationObject_getObjectAddress(io)] = CS101_ASDU_getTypeID(asdu);
+                InformationObject_destroy(io);
+            }
+        });
+        return res;
+    }
+}
+
+TEST(TCyclicTransmissionTest, Periods)
+{
+    using std::chrono::milliseconds;
+    IEC104::TCyclicTransmission cyclic({{1, milliseconds(1000)}, {2, milliseconds(2000)}, {3, milliseconds(1000)}},
+                                       START);
+    ASSERT_EQ(cyclic.Size(), 3);
+
+    IEC104::TInformationObjects objs;
+    objs.MeasuredValueShort.emplace_back(1, 1.5f);
+    objs.MeasuredValueScaled.emplace_back(2, 10);
+    objs.MeasuredValueScaled.emplace_back(4, 20); // Not cyclic
+    cyclic.Update(objs);
+
+    // Objects are sent not later than one tick after deadline. Object 3 has no value, so it is not sent
+    ASSERT_TRUE(Send(cyclic, START + milliseconds(900)).empty());
+    ASSERT_EQ(Send(cyclic, START + milliseconds(1100)), (std::map<int, TypeID>{{1, M_ME_NC_1}}));
+    ASSERT_TRUE(Send(cyclic, START + milliseconds(1500)).empty());
+    ASSERT_EQ(Send(cyclic, START + milliseconds(2100)), (std::map<int, TypeID>{{1, M_ME_NC_1}, {2, M_ME_NB_1}}));
+
+    // Late transmission restarts the cycle of object 1, object 2 is still in its cycle
+    ASSERT_EQ(Send(cyclic, START + milliseconds(5500)), (std::map<int, TypeID>{{1, M_ME_NC_1}, {2, M_ME_NB_1}}));
+    ASSERT_TRUE(Send(cyclic, START + milliseconds(6000)).empty());
+    ASSERT_EQ(Send(cyclic, START + milliseconds(6100)), (std::map<int, TypeID>{{2, M_ME_NB_1}}));
+    ASSERT_EQ(Send(cyclic, START + milliseconds(6600)), (std::map<int, TypeID>{{1, M_ME_NC_1}}));
+}
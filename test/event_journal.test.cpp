@@ -0,0 +1,127 @@
+#include "event_journal.h"
+
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace IEC104;
+
+namespace
+{
+    const auto TIMESTAMP = std::chrono::system_clock::time_point(std::chrono::milliseconds(1600000000123));
+}
+
+class TEventJournalTest: public testing::Test
+{
+protected:
+    std::string FileName;
+
+    void SetUp()
+    {
+        char fileName[] = "/tmp/event_journal_test_XXXXXX";
+        auto fd = mkstemp(fileName);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        FileName = fileName;
+    }
+
+    void TearDown()
+    {
+        unlink(FileName.c_str());
+    }
+};
+
+TEST_F(TEventJournalTest, AppendPeekPop)
+{
+    TEventJournal journal(FileName, 10, TJournalOverflowPolicy::DropOldest);
+    ASSERT_TRUE(journal.IsEmpty());
+
+    TInformationObjects objs;
+    objs.SinglePoint.emplace_back(1, true);
+    objs.SinglePointWithTimestamp.emplace_back(2, TIMESTAMP, true);
+    objs.SinglePointWithTimestamp.emplace_back(3, TIMESTAMP, false, QUALITY_INVALID);
+    objs.MeasuredValueShortWithTimestamp.emplace_back(4, TIMESTAMP, 1.5f);
+    objs.MeasuredValueScaledWithTimestamp.emplace_back(5, TIMESTAMP, -7);
+    ASSERT_EQ(journal.Append(objs), 0);
+    ASSERT_EQ(journal.Size(), 4);
+
+    // Only records of the same type are returned
+    TInformationObjects res;
+    ASSERT_EQ(journal.Peek(10, res), 2);
+    ASSERT_EQ(res.SinglePointWithTimestamp.size(), 2);
+    ASSERT_EQ(res.SinglePointWithTimestamp[0].Address, 2);
+    ASSERT_EQ(res.SinglePointWithTimestamp[0].Value, true);
+    ASSERT_EQ(res.SinglePointWithTimestamp[0].Quality, QUALITY_GOOD);
+    ASSERT_TRUE(res.SinglePointWithTimestamp[0].Timestamp == TIMESTAMP);
+    ASSERT_EQ(res.SinglePointWithTimestamp[1].Address, 3);
+    ASSERT_EQ(res.SinglePointWithTimestamp[1].Value, false);
+    ASSERT_EQ(res.SinglePointWithTimestamp[1].Quality, QUALITY_INVALID);
+    ASSERT_EQ(journal.Size(), 4);
+    journal.Pop(2);
+
+    res = TInformationObjects();
+    ASSERT_EQ(journal.Peek(10, res), 1);
+    ASSERT_EQ(res.MeasuredValueShortWithTimestamp.size(), 1);
+    ASSERT_EQ(res.MeasuredValueShortWithTimestamp[0].Address, 4);
+    ASSERT_EQ(res.MeasuredValueShortWithTimestamp[0].Value, 1.5f);
+    journal.Pop(1);
+
+    res = TInformationObjects();
+    ASSERT_EQ(journal.Peek(10, res), 1);
+    ASSERT_EQ(res.MeasuredValueScaledWithTimestamp.size(), 1);
+    ASSERT_EQ(res.MeasuredValueScaledWithTimestamp[0].Address, 5);
+    ASSERT_EQ(res.MeasuredValueScaledWithTimestamp[0].Value, -7);
+    journal.Pop(1);
+    ASSERT_TRUE(journal.IsEmpty());
+}
+
+TEST_F(TEventJournalTest, Overflow)
+{
+    TInformationObjects objs;
+    for (uint32_t i = 1; i <= 5; ++i) {
+        objs.MeasuredValueScaledWithTimestamp.emplace_back(i, TIMESTAMP, i);
+    }
+
+    {
+        TEventJournal journal(FileName, 3, TJournalOverflowPolicy::DropOldest);
+        ASSERT_EQ(journal.Append(objs), 2);
+        TInformationObjects res;
+        ASSERT_EQ(journal.Peek(10, res), 3);
+        ASSERT_EQ(res.MeasuredValueScaledWithTimestamp.front().Address, 3);
+        ASSERT_EQ(res.MeasuredValueScaledWithTimestamp.back().Address, 5);
+        journal.Pop(3);
+    }
+    {
+        TEventJournal journal(FileName, 3, TJournalOverflowPolicy::DropNewest);
+        ASSERT_EQ(journal.Append(objs), 2);
+        TInformationObjects res;
+        ASSERT_EQ(journal.Peek(10, res), 3);
+        ASSERT_EQ(res.MeasuredValueScaledWithTimestamp.front().Address, 1);
+        ASSERT_EQ(res.MeasuredValueScaledWithTimestamp.back().Address, 3);
+    }
+}
+
+TEST_F(TEventJournalTest, Persistence)
+{
+    TInformationObjects objs;
+    objs.MeasuredValueShortWithTimestamp.emplace_back(1, TIMESTAMP, 1.0f);
+    objs.MeasuredValueShortWithTimestamp.emplace_back(2, TIMESTAMP, 2.0f);
+    {
+        TEventJournal journal(FileName, 10, TJournalOverflowPolicy::DropOldest);
+        journal.Append(objs);
+        journal.Pop(1);
+    }
+    {
+        TEventJournal journal(FileName, 10, TJournalOverflowPolicy::DropOldest);
+        TInformationObjects res;
+        ASSERT_EQ(journal.Peek(10, res), 1);
+        ASSERT_EQ(res.MeasuredValueShortWithTimestamp[0].Address, 2);
+        ASSERT_EQ(res.MeasuredValueShortWithTimestamp[0].Value, 2.0f);
+        ASSERT_TRUE(res.MeasuredValueShortWithTimestamp[0].Timestamp == TIMESTAMP);
+    }
+    {
+        // Journal with different capacity is cleared
+        TEventJournal journal(FileName, 5, TJournalOverflowPolicy::DropOldest);
+        ASSERT_TRUE(journal.IsEmpty());
+    }
+}
@@ -2,6 +2,7 @@
 #include "config_parser.h"
 
 #include <gtest/gtest.h>
+#include <thread>
 #include <vector>
 
 #include <wblib/json_utils.h>
@@ -13,27 +14,37 @@ using namespace WBMQTT;
 
 namespace
 {
-    void Dump(Testing::TLoggedFixture& fixture, const IEC104::TInformationObjects& obj)
+    IEC104::TCommandValue MakeCommandValue(uint32_t address, const std::string& value)
     {
-        for (auto v: obj.SinglePoint) {
-            fixture.Emit() << "SP: " << v.Address << " = " << v.Value;
-        }
-        for (auto v: obj.MeasuredValueShort) {
-            fixture.Emit() << "MShort: " << v.Address << " = " << v.Value;
-        }
-        for (auto v: obj.MeasuredValueScaled) {
-            fixture.Emit() << "MScaled: " << v.Address << " = " << v.Value;
-        }
-        for (auto v: obj.SinglePointWithTimestamp) {
-            fixture.Emit() << "SP: " << v.Address << " = " << v.Value << ", with timestamp";
-        }
-        for (auto v: obj.MeasuredValueShortWithTimestamp) {
-            fixture.Emit() << "MShort: " << v.Address << " = " << v.Value << ", with timestamp";
-        }
-        for (auto v: obj.MeasuredValueScaledWithTimestamp) {
-            fixture.Emit() << "MScaled: " << v.Address << " = " << v.Value << ", with timestamp";
+        IEC104::TCommandValue res;
+        res.Address = address;
+        res.ValueSize = value.copy(res.Value.data(), res.Value.size());
+        return res;
+    }
+
+    template<class T>
+    void Dump(Testing::TLoggedFixture& fixture, const char* type, const std::vector<T>& objs, const char* suffix = "")
+    {
+        for (const auto& v: objs) {
+            // Unary plus prints one byte values as numbers
+            fixture.Emit() << type << ": " << v.Address << " = " << +v.Value << suffix << ", quality "
+                           << static_cast<int>(v.Quality);
         }
     }
+
+    void Dump(Testing::TLoggedFixture& fixture, const IEC104::TInformationObjects& obj)
+    {
+        Dump(fixture, "SP", obj.SinglePoint);
+        Dump(fixture, "MShort", obj.MeasuredValueShort);
+        Dump(fixture, "MScaled", obj.MeasuredValueScaled);
+        Dump(fixture, "DP", obj.DoublePoint);
+        Dump(fixture, "MNormalized", obj.MeasuredValueNormalized);
+        Dump(fixture, "BO", obj.BitString);
+        Dump(fixture, "ST", obj.StepPosition);
+        Dump(fixture, "SP", obj.SinglePointWithTimestamp, ", with timestamp");
+        Dump(fixture, "MShort", obj.MeasuredValueShortWithTimestamp, ", with timestamp");
+        Dump(fixture, "MScaled", obj.MeasuredValueScaledWithTimestamp, ", with timestamp");
+    }
 }
 
 class TGatewayTest: public Testing::TLoggedFixture
@@ -42,6 +53,7 @@ protected:
     std::string TestRootDir;
     std::string SchemaFile;
     PDeviceDriver Driver;
+    PMqttClient MqttClient;
     TDeviceConfig Config;
     PControl Control1;
     PControl Control2;
@@ -57,8 +69,8 @@ protected:
         SchemaFile = TestRootDir + "/../../wb-mqtt-iec104.schema.json";
 
         auto mqttBroker = Testing::NewFakeMqttBroker(*this);
-        auto mqttClient = mqttBroker->MakeClient("test");
-        auto backend = NewDriverBackend(mqttClient);
+        MqttClient = mqttBroker->MakeClient("test");
+        auto backend = NewDriverBackend(MqttClient);
         Driver = NewDriver(TDriverArgs{}.SetId("test").SetBackend(backend));
 
         Driver->StartLoop();
@@ -87,6 +99,11 @@ protected:
                 .GetValue();
         tx->End();
     }
+
+    void PublishError(const std::string& control, const std::string& error)
+    {
+        MqttClient->Publish({"/devices/test/controls/" + control + "/meta/error", error, 1, true}).Sync();
+    }
 };
 
 class TFakeIecServer: public IEC104::IServer
@@ -106,25 +123,76 @@ public:
         Dump(Fixture, obj);
     }
 
+    void UpdateValues(const IEC104::TInformationObjects& obj)
+    {
+        Fixture.Emit() << "IEC104::IServer::UpdateValues";
+        Dump(Fixture, obj);
+    }
+
+    void Reconfigure(const IEC104::TServerConfig& config, const IEC104::TInformationObjects& obj)
+    {
+        Fixture.Emit() << "IEC104::IServer::Reconfigure";
+        Dump(Fixture, obj);
+    }
+
     void SetHandler(IEC104::IHandler* handler)
     {}
 };
 
+//! Activates a master connection as soon as the gateway becomes the handler, before MQTT values are loaded
+class TActivatingIecServer: public TFakeIecServer
+{
+    Testing::TLoggedFixture& Fixture;
+
+public:
+    TActivatingIecServer(Testing::TLoggedFixture& fixture): TFakeIecServer(fixture), Fixture(fixture)
+    {}
+
+    void SetHandler(IEC104::IHandler* handler)
+    {
+        Fixture.Emit() << "Activation";
+        Dump(Fixture, handler->GetInformationObjectsValues());
+    }
+};
+
 TEST_F(TGatewayTest, SetParameter)
 {
     TFakeIecServer iecServer(*this);
     TGateway gw(Driver, &iecServer, Config);
 
     // Valid params
-    ASSERT_TRUE(gw.SetParameter(1, "10.21"));
-    ASSERT_TRUE(gw.SetParameter(2, "1"));
-    ASSERT_TRUE(gw.SetParameter(3, "-1"));
-    ASSERT_TRUE(gw.SetParameter(4, "9.87"));
-    ASSERT_TRUE(gw.SetParameter(5, "0"));
-    ASSERT_TRUE(gw.SetParameter(6, "-15"));
+    ASSERT_TRUE(gw.SetParameters({MakeCommandValue(1, "10.21")}));
+    gw.WaitForChanges();
+    ASSERT_TRUE(gw.SetParameters({MakeCommandValue(2, "1")}));
+    gw.WaitForChanges();
+    ASSERT_TRUE(gw.SetParameters({MakeCommandValue(3, "-1")}));
+    gw.WaitForChanges();
+    ASSERT_TRUE(gw.SetParameters({MakeCommandValue(4, "9.87")}));
+    gw.WaitForChanges();
+    ASSERT_TRUE(gw.SetParameters({MakeCommandValue(5, "0")}));
+    gw.WaitForChanges();
+    ASSERT_TRUE(gw.SetParameters({MakeCommandValue(6, "-15")}));
+    gw.WaitForChanges();
 
     // Unknown ioa
-    ASSERT_FALSE(gw.SetParameter(7, "7"));
+    ASSERT_FALSE(gw.SetParameters({MakeCommandValue(7, "7")}));
+
+    // Command with unknown ioa is rejected as a whole
+    ASSERT_FALSE(gw.SetParameters({MakeCommandValue(1, "1"), MakeCommandValue(7, "7")}));
+}
+
+TEST_F(TGatewayTest, SetParametersWithMissingControl)
+{
+    // The object is configured, but MQTT broker doesn't have its control
+    auto config = Config;
+    TIecInformationObject obj{7, MeasuredValueShort};
+    config["test"].emplace("missing", obj);
+    TFakeIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, config);
+
+    // Nothing is published, even for the values before the missing control
+    ASSERT_FALSE(gw.SetParameters({MakeCommandValue(1, "10.21"), MakeCommandValue(7, "7")}));
+    gw.WaitForChanges();
 }
 
 TEST_F(TGatewayTest, GetInformationObjectsValues)
@@ -139,12 +207,138 @@ TEST_F(TGatewayTest, OnValueChanged)
     TFakeIecServer iecServer(*this);
     TGateway gw(Driver, &iecServer, Config);
     auto tx = Driver->BeginTx();
+    // Values are converted by the gateway's thread, every change is waited for to keep output order
     ControlNotInConfig->SetValue(tx, 123.123).Sync();
+    gw.WaitForChanges();
     Control1->SetValue(tx, 2.34).Sync();
+    gw.WaitForChanges();
     Control2->SetValue(tx, true).Sync();
+    gw.WaitForChanges();
     Control3->SetRawValue(tx, "200").Sync();
+    gw.WaitForChanges();
     Control4->SetValue(tx, 5.67).Sync();
+    gw.WaitForChanges();
     Control5->SetValue(tx, false).Sync();
+    gw.WaitForChanges();
     Control6->SetRawValue(tx, "768").Sync();
+    gw.WaitForChanges();
+    tx->End();
+}
+
+TEST_F(TGatewayTest, ValuesCache)
+{
+    TFakeIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, Config);
+    auto tx = Driver->BeginTx();
+    Control1->SetRawValue(tx, "2.34").Sync();
+    gw.WaitForChanges();
+    Control3->SetRawValue(tx, "200").Sync();
+    gw.WaitForChanges();
+    Control5->SetRawValue(tx, "0").Sync();
+    gw.WaitForChanges();
+    // Not convertible value must not overwrite last known one
+    Control1->SetRawValue(tx, "bad").Sync();
+    gw.WaitForChanges();
+    tx->End();
+    Dump(*this, gw.GetInformationObjectsValues());
+}
+
+TEST_F(TGatewayTest, Deadband)
+{
+    TFakeIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, LoadConfig(TestRootDir + "/deadband.conf", SchemaFile).Devices);
+    auto tx = Driver->BeginTx();
+    // Absolute deadband 1
+    Control1->SetRawValue(tx, "1.5").Sync();
+    gw.WaitForChanges();
+    Control1->SetRawValue(tx, "2.5").Sync();
+    gw.WaitForChanges();
+    Control1->SetRawValue(tx, "3").Sync();
+    gw.WaitForChanges();
+    // Deadband 10%
+    Control3->SetRawValue(tx, "130").Sync();
+    gw.WaitForChanges();
+    Control3->SetRawValue(tx, "140").Sync();
+    gw.WaitForChanges();
+    // Send interval, it starts with sending of loaded value
+    Control4->SetRawValue(tx, "4").Sync();
+    gw.WaitForChanges();
+    Control4->SetRawValue(tx, "5").Sync();
+    gw.WaitForChanges();
+    tx->End();
+    // Filtered values must be returned on interrogation
+    Dump(*this, gw.GetInformationObjectsValues());
+}
+
+TEST_F(TGatewayTest, SendInterval)
+{
+    TFakeIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, LoadConfig(TestRootDir + "/send_interval.conf", SchemaFile).Devices);
+    auto tx = Driver->BeginTx();
+    // Loaded value is sent, changes during its send interval are held back,
+    // the last one is sent when the interval expires
+    Control1->SetRawValue(tx, "2").Sync();
+    gw.WaitForChanges();
+    Control1->SetRawValue(tx, "3").Sync();
+    gw.WaitForChanges();
+    Control1->SetRawValue(tx, "4").Sync();
+    gw.WaitForChanges();
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    Emit() << "Send interval of 1 is expired";
+
+    // Held back change is dropped if the next one returns into deadband of the sent value
+    Control3->SetRawValue(tx, "130").Sync();
+    gw.WaitForChanges();
+    Control3->SetRawValue(tx, "140").Sync();
+    gw.WaitForChanges();
+    Control3->SetRawValue(tx, "132").Sync();
+    gw.WaitForChanges();
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    Emit() << "Send interval of 3 is expired";
     tx->End();
 }
+
+TEST_F(TGatewayTest, Quality)
+{
+    TFakeIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, LoadConfig(TestRootDir + "/quality.conf", SchemaFile).Devices, MqttClient);
+    // Read error makes the value invalid, poll period miss makes it not topical
+    PublishError("test3", "r");
+    PublishError("test3", "rp");
+    PublishError("test3", "");
+    PublishError("test3", "p");
+    // Write error doesn't change quality
+    PublishError("test3", "pw");
+    PublishError("test3", "");
+
+    // The value which is not received during stale timeout becomes not topical, a new value makes it topical again
+    std::this_thread::sleep_for(std::chrono::milliseconds(3000));
+    Emit() << "Stale timeout of 1 is expired";
+    auto tx = Driver->BeginTx();
+    Control1->SetRawValue(tx, "2").Sync();
+    gw.WaitForChanges();
+    tx->End();
+}
+
+TEST_F(TGatewayTest, ActivationBeforeLoad)
+{
+    // The master gets invalid values on activation, so loaded values are sent to it spontaneously
+    TActivatingIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, Config);
+}
+
+TEST_F(TGatewayTest, Reload)
+{
+    TFakeIecServer iecServer(*this);
+    TGateway gw(Driver, &iecServer, Config);
+    auto tx = Driver->BeginTx();
+    Control1->SetRawValue(tx, "2.34").Sync();
+    gw.WaitForChanges();
+    tx->End();
+
+    // Objects 1 and 3 are kept with their values, 2, 4, 5 and 6 are removed and sent as invalid,
+    // 7 is added and sent after its value is loaded
+    auto config = LoadConfig(TestRootDir + "/reload.conf", SchemaFile);
+    gw.Reload(config.Devices, config.Iec);
+    Dump(*this, gw.GetInformationObjectsValues());
+}
@@ -0,0 +1,207 @@
+#include "interrogation_image.h"
+
+#include <gtest/gtest.h>
+#include <map>
+
+#include "cs101_information_objects.h"
+
+namespace
+{
+    sCS101_AppLayerParameters AppLayerParameters = {1, 1, 2, 0, 2, 3, 249};
+}
+
+TEST(TInterrogationImageTest, SendAndPatch)
+{
+    IEC104::TInterrogationImage image(&AppLayerParameters);
+
+    IEC104::TInformationObjects objs;
+    for (uint32_t ioa = 1; ioa <= 100; ++ioa) {
+        objs.MeasuredValueShort.emplace_back(ioa, ioa);
+    }
+    objs.SinglePoint.emplace_back(1000, true);
+    image.Update(objs);
+    ASSERT_EQ(image.Size(), 101);
+
+    IEC104::TInformationObjects changed;
+    changed.MeasuredValueShort.emplace_back(50, -1.5);
+    changed.MeasuredValueShort.emplace_back(101, 101);
+    image.Update(changed);
+    ASSERT_EQ(image.Size(), 102);
+
+    std::map<int, float> values;
+    size_t singlePoints = 0;
+    size_t asduCount = 0;
+    image.Send(CS101_COT_INTERROGATED_BY_STATION, 1, [&](CS101_ASDU asdu) {
+        ++asduCount;
+        ASSERT_EQ(CS101_ASDU_getCOT(asdu), CS101_COT_INTERROGATED_BY_STATION);
+        ASSERT_EQ(CS101_ASDU_getCA(asdu), 1);
+        for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+            auto io = CS101_ASDU_getElement(asdu, i);
+            if (CS101_ASDU_getTypeID(asdu) == M_ME_NC_1) {
+                values[InformationObject_getObjectAddress(io)] = MeasuredValueShort_getValue((MeasuredValueShort)io);
+            } else {
+                ASSERT_EQ(CS101_ASDU_getTypeID(asdu), M_SP_NA_1);
+                ASSERT_EQ(InformationObject_getObjectAddress(io), 1000);
+                ++singlePoints;
+            }
+            InformationObject_destroy(io);
+        }
+    });
+
+    // 101 short floats by 8 bytes in 243 bytes payload and one ASDU with single point
+    ASSERT_EQ(asduCount, 5);
+    ASSERT_EQ(singlePoints, 1);
+    ASSERT_EQ(values.size(), 101);
+    ASSERT_FLOAT_EQ(values[1], 1);
+    ASSERT_FLOAT_EQ(values[50], -1.5);
+    ASSERT_FLOAT_EQ(values[101], 101);
+}
+
+TEST(TInterrogationImageTest, Groups)
+{
+    IEC104::TInterrogationImage image(&AppLayerParameters, {{1, 1}, {2, 16}, {3, 1}});
+
+    IEC104::TInformationObjects objs;
+    objs.SinglePoint.emplace_back(1, true);
+    objs.SinglePoint.emplace_back(2, true);
+    objs.MeasuredValueScaled.emplace_back(3, 10);
+    objs.MeasuredValueScaled.emplace_back(4, 20);
+    image.Update(objs);
+
+    IEC104::TInformationObjects changed;
+    changed.MeasuredValueScaled.emplace_back(3, 30);
+    image.Update(changed);
+
+    auto getGroup = [&](uint8_t group) {
+        std::map<int, int> values;
+        image.SendGroup(group, CS101_COT_INTERROGATED_BY_GROUP_1, 1, [&](CS101_ASDU asdu) {
+            ASSERT_EQ(CS101_ASDU_getCOT(asdu), CS101_COT_INTERROGATED_BY_GROUP_1);
+            for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+                auto io = CS101_ASDU_getElement(asdu, i);
+                if (CS101_ASDU_getTypeID(asdu) == M_ME_NB_1) {
+                    values[InformationObject_getObjectAddress(io)] =
+                        MeasuredValueScaled_getValue((MeasuredValueScaled)io);
+                } else {
+                    values[InformationObject_getObjectAddress(io)] =
+                        SinglePointInformation_getValue((SinglePointInformation)io);
+                }
+                InformationObject_destroy(io);
+            }
+        });
+        return values;
+    };
+
+    ASSERT_EQ(getGroup(1), (std::map<int, int>{{1, 1}, {3, 30}}));
+    ASSERT_EQ(getGroup(16), (std::map<int, int>{{2, 1}}));
+    ASSERT_TRUE(getGroup(2).empty());
+    ASSERT_TRUE(getGroup(17).empty());
+    ASSERT_EQ(image.Size(), 4);
+}
+
+TEST(TInterrogationImageTest, Sequences)
+{
+    IEC104::TInterrogationImage image(&AppLayerParameters, {}, true);
+
+    IEC104::TInformationObjects objs;
+    for (uint32_t ioa = 1; ioa <= 200; ++ioa) {
+        if (ioa != 150) {
+            objs.MeasuredValueShort.emplace_back(ioa, ioa);
+        }
+    }
+    objs.MeasuredValueShort.emplace_back(300, 300);
+    objs.MeasuredValueShortWithTimestamp.emplace_back(301, std::chrono::system_clock::now(), 301);
+    objs.SinglePoint.emplace_back(1000, true);
+    image.Update(objs);
+
+    // Added objects are sorted into place
+    IEC104::TInformationObjects changed;
+    changed.MeasuredValueShort.emplace_back(201, 201);
+    changed.MeasuredValueShort.emplace_back(150, 150);
+    changed.MeasuredValueShort.emplace_back(50, -1.5);
+    image.Update(changed);
+    ASSERT_EQ(image.Size(), 204);
+
+    std::map<int, float> values;
+    std::vector<int> sequenceSizes;
+    size_t asduCount = 0;
+    image.Send(CS101_COT_INTERROGATED_BY_STATION, 1, [&](CS101_ASDU asdu) {
+        ++asduCount;
+        if (CS101_ASDU_isSequence(asdu)) {
+            ASSERT_EQ(CS101_ASDU_getTypeID(asdu), M_ME_NC_1);
+            sequenceSizes.push_back(CS101_ASDU_getNumberOfElements(asdu));
+        }
+        if (CS101_ASDU_getTypeID(asdu) != M_ME_NC_1) {
+            return;
+        }
+        for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+            auto io = CS101_ASDU_getElement(asdu, i);
+            values[InformationObject_getObjectAddress(io)] = MeasuredValueShort_getValue((MeasuredValueShort)io);
+            InformationObject_destroy(io);
+        }
+    });
+
+    // Addresses 1-201 in sequences of 48 values by 5 bytes after 3 bytes address in 243 bytes payload,
+    // single short float 300, float with timestamp and single point can't be sent as sequences
+    ASSERT_EQ(sequenceSizes, (std::vector<int>{48, 48, 48, 48, 9}));
+    ASSERT_EQ(asduCount, 8);
+    ASSERT_EQ(values.size(), 202);
+    for (uint32_t ioa = 1; ioa <= 201; ++ioa) {
+        if (ioa != 50) {
+            ASSERT_FLOAT_EQ(values[ioa], ioa);
+        }
+    }
+    ASSERT_FLOAT_EQ(values[50], -1.5);
+    ASSERT_FLOAT_EQ(values[300], 300);
+}
+
+TEST(TInterrogationImageTest, AdditionalTypes)
+{
+    IEC104::TInterrogationImage image(&AppLayerParameters, {}, true);
+
+    IEC104::TInformationObjects objs;
+    objs.DoublePoint.emplace_back(1, IEC104::DOUBLE_POINT_ON);
+    objs.DoublePoint.emplace_back(2, IEC104::DOUBLE_POINT_INTERMEDIATE, IEC104::QUALITY_INVALID);
+    objs.MeasuredValueNormalized.emplace_back(3, 0.5f);
+    objs.BitString.emplace_back(4, 0xDEADBEEF);
+    objs.StepPosition.emplace_back(5, -64);
+    objs.StepPosition.emplace_back(6, 63);
+    image.Update(objs);
+    ASSERT_EQ(image.Size(), 6);
+
+    std::map<int, double> values;
+    std::map<int, int> types;
+    image.Send(CS101_COT_INTERROGATED_BY_STATION, 1, [&](CS101_ASDU asdu) {
+        for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+            auto io = CS101_ASDU_getElement(asdu, i);
+            auto address = InformationObject_getObjectAddress(io);
+            types[address] = CS101_ASDU_getTypeID(asdu);
+            switch (CS101_ASDU_getTypeID(asdu)) {
+                case M_DP_NA_1:
+                    values[address] = DoublePointInformation_getValue((DoublePointInformation)io);
+                    break;
+                case M_ME_NA_1:
+                    values[address] = MeasuredValueNormalized_getValue((MeasuredValueNormalized)io);
+                    break;
+                case M_BO_NA_1:
+                    values[address] = BitString32_getValue((BitString32)io);
+                    break;
+                case M_ST_NA_1:
+                    values[address] = StepPositionInformation_getValue((StepPositionInformation)io);
+                    break;
+                default:
+                    break;
+            }
+            InformationObject_destroy(io);
+        }
+    });
+
+    ASSERT_EQ(types,
+              (std::map<int, int>{
+                  {1, M_DP_NA_1}, {2, M_DP_NA_1}, {3, M_ME_NA_1}, {4, M_BO_NA_1}, {5, M_ST_NA_1}, {6, M_ST_NA_1}}));
+    ASSERT_EQ(values[1], IEC60870_DOUBLE_POINT_ON);
+    ASSERT_EQ(values[2], IEC60870_DOUBLE_POINT_INTERMEDIATE);
+    ASSERT_NEAR(values[3], 0.5, 1e-4);
+    ASSERT_EQ(values[4], 0xDEADBEEF);
+    ASSERT_EQ(values[5], -64);
+    ASSERT_EQ(values[6], 63);
+}
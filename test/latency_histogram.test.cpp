@@ -0,0 +1,35 @@
+#include "latency_histogram.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(TLatencyHistogramTest, Empty)
+{
+    TLatencyHistogram h;
+    ASSERT_EQ(h.GetCount(), 0);
+    ASSERT_EQ(h.GetPercentile(50).count(), 0);
+    ASSERT_EQ(h.GetMax().count(), 0);
+}
+
+TEST(TLatencyHistogramTest, Percentiles)
+{
+    TLatencyHistogram h;
+    for (int i = 0; i < 90; ++i) {
+        h.Add(std::chrono::microseconds(100));
+    }
+    for (int i = 0; i < 9; ++i) {
+        h.Add(std::chrono::milliseconds(3));
+    }
+    h.Add(std::chrono::seconds(1));
+
+    ASSERT_EQ(h.GetCount(), 100);
+    ASSERT_EQ(h.GetPercentile(50).count(), 128);
+    ASSERT_EQ(h.GetPercentile(90).count(), 128);
+    ASSERT_EQ(h.GetPercentile(99).count(), 4096);
+    ASSERT_EQ(h.GetPercentile(100).count(), 1048576);
+    ASSERT_EQ(h.GetMax().count(), 1000000);
+
+    std::stringstream str;
+    str << h;
+    ASSERT_EQ(str.str(), "count: 100, p50: <128us, p90: <128us, p99: <4096us, max: 1000000us");
+}
@@ -0,0 +1,67 @@
+#include "mpsc_ring.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(TMpscRingTest, PushPop)
+{
+    TMpscRing<std::string> ring(3);
+    ASSERT_EQ(ring.Capacity(), 4);
+
+    std::string value;
+    ASSERT_FALSE(ring.TryPop(value));
+    for (size_t turn = 0; turn < 3; ++turn) {
+        for (size_t i = 0; i < 4; ++i) {
+            std::string v = std::to_string(i);
+            ASSERT_TRUE(ring.TryPush(std::move(v)));
+        }
+        // Value is not moved if the queue is full
+        value = "overflow";
+        ASSERT_FALSE(ring.TryPush(std::move(value)));
+        ASSERT_EQ(value, "overflow");
+
+        for (size_t i = 0; i < 4; ++i) {
+            ASSERT_TRUE(ring.TryPop(value));
+            ASSERT_EQ(value, std::to_string(i));
+        }
+        ASSERT_FALSE(ring.TryPop(value));
+    }
+}
+
+TEST(TMpscRingTest, ManyProducers)
+{
+    const size_t producersCount = 4;
+    const size_t valuesCount = 100000;
+    TMpscRing<size_t> ring(64);
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < producersCount; ++p) {
+        producers.emplace_back([&ring, p]() {
+            for (size_t i = 0; i < valuesCount; ++i) {
+                size_t value = p * valuesCount + i;
+                while (!ring.TryPush(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Values of every producer must come in order
+    std::vector<size_t> next(producersCount, 0);
+    size_t value;
+    for (size_t received = 0; received < producersCount * valuesCount;) {
+        if (!ring.TryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        auto p = value / valuesCount;
+        ASSERT_EQ(value % valuesCount, next[p]);
+        ++next[p];
+        ++received;
+    }
+    for (auto& producer: producers) {
+        producer.join();
+    }
+}
@@ -0,0 +1,54 @@
+#include "point_index.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    TDeviceConfig MakeConfig(uint32_t ioaStep)
+    {
+        TDeviceConfig config;
+        config["dev1"].insert({"c1", {1 * ioaStep, MeasuredValueShort}});
+        config["dev1"].insert({"c2", {2 * ioaStep, SinglePoint}});
+        config["dev1"].insert({"c2", {3 * ioaStep, SinglePointWithTimestamp}});
+        config["dev2"].insert({"c1", {4 * ioaStep, MeasuredValueScaled}});
+        return config;
+    }
+
+    void CheckIndex(const TPointIndex& index, uint32_t ioaStep)
+    {
+        ASSERT_EQ(index.Size(), 4);
+
+        auto slots = index.Find("dev1", "c2");
+        ASSERT_EQ(slots.Last - slots.First, 2);
+        ASSERT_EQ(index.GetObject(slots.First).Address, 2 * ioaStep);
+        ASSERT_EQ(index.GetObject(slots.First + 1).Address, 3 * ioaStep);
+
+        slots = index.Find("dev2", "c1");
+        ASSERT_EQ(slots.Last - slots.First, 1);
+        ASSERT_EQ(index.GetObject(slots.First).Type, MeasuredValueScaled);
+
+        ASSERT_TRUE(index.Find("dev2", "c2").IsEmpty());
+        ASSERT_TRUE(index.Find("dev3", "c1").IsEmpty());
+        ASSERT_TRUE(index.Find("dev1c", "1").IsEmpty());
+
+        for (uint32_t i = 1; i <= 4; ++i) {
+            auto slot = index.Find(i * ioaStep);
+            ASSERT_NE(slot, TPointIndex::NO_SLOT);
+            ASSERT_EQ(index.GetObject(slot).Address, i * ioaStep);
+        }
+        ASSERT_EQ(index.GetControl(index.Find(4 * ioaStep)).Device, "dev2");
+        ASSERT_EQ(index.Find(0), TPointIndex::NO_SLOT);
+        ASSERT_EQ(index.Find(5 * ioaStep), TPointIndex::NO_SLOT);
+        ASSERT_EQ(index.Find(16777215), TPointIndex::NO_SLOT);
+    }
+}
+
+TEST(TPointIndexTest, DenseAddresses)
+{
+    CheckIndex(TPointIndex(MakeConfig(1)), 1);
+}
+
+TEST(TPointIndexTest, SparseAddresses)
+{
+    CheckIndex(TPointIndex(MakeConfig(100000)), 100000);
+}
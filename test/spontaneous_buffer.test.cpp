@@ -0,0 +1,74 @@
+#include "spontaneous_buffer.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    IEC104::TInformationObjects MakeChange(uint32_t ioa, float value)
+    {
+        IEC104::TInformationObjects objs;
+        objs.MeasuredValueShort.emplace_back(ioa, value);
+        objs.MeasuredValueShortWithTimestamp.emplace_back(ioa + 100, std::chrono::system_clock::now(), value);
+        return objs;
+    }
+}
+
+TEST(TSpontaneousBufferTest, KeepLatest)
+{
+    IEC104::TSpontaneousBuffer buf(false);
+    ASSERT_TRUE(buf.IsEmpty());
+    ASSERT_EQ(buf.Add(MakeChange(1, 1)), 2);
+    ASSERT_EQ(buf.Add(MakeChange(2, 2)), 4);
+    ASSERT_EQ(buf.Add(MakeChange(1, 3)), 4);
+
+    auto objs = buf.Take();
+    ASSERT_TRUE(buf.IsEmpty());
+    ASSERT_EQ(objs.MeasuredValueShort.size(), 2);
+    ASSERT_EQ(objs.MeasuredValueShort[0].Address, 1);
+    ASSERT_FLOAT_EQ(objs.MeasuredValueShort[0].Value, 3);
+    ASSERT_EQ(objs.MeasuredValueShort[1].Address, 2);
+    ASSERT_EQ(objs.MeasuredValueShortWithTimestamp.size(), 2);
+    ASSERT_FLOAT_EQ(objs.MeasuredValueShortWithTimestamp[0].Value, 3);
+
+    ASSERT_EQ(buf.Add(MakeChange(1, 4)), 2);
+    ASSERT_FLOAT_EQ(buf.Take().MeasuredValueShort[0].Value, 4);
+}
+
+TEST(TSpontaneousBufferTest, KeepEventsHistory)
+{
+    IEC104::TSpontaneousBuffer buf(true);
+    buf.Add(MakeChange(1, 1));
+    buf.Add(MakeChange(1, 2));
+    ASSERT_EQ(buf.Add(MakeChange(1, 3)), 4);
+
+    auto objs = buf.Take();
+    ASSERT_EQ(objs.MeasuredValueShort.size(), 1);
+    ASSERT_FLOAT_EQ(objs.MeasuredValueShort[0].Value, 3);
+    ASSERT_EQ(objs.MeasuredValueShortWithTimestamp.size(), 3);
+    ASSERT_FLOAT_EQ(objs.MeasuredValueShortWithTimestamp[0].Value, 1);
+    ASSERT_FLOAT_EQ(objs.MeasuredValueShortWithTimestamp[2].Value, 3);
+}
+
+TEST(TSpontaneousBufferTest, AddressWithDifferentTypes)
+{
+    // Reconfiguration can change type of an address while its old value is still pending
+    IEC104::TSpontaneousBuffer buf(false);
+    IEC104::TInformationObjects objs;
+    objs.MeasuredValueShort.emplace_back(2, 1.0f);
+    objs.MeasuredValueShort.emplace_back(1, 2.0f, IEC104::QUALITY_INVALID);
+    ASSERT_EQ(buf.Add(objs), 2);
+
+    objs = IEC104::TInformationObjects();
+    objs.SinglePoint.emplace_back(1, true);
+    ASSERT_EQ(buf.Add(objs), 3);
+    objs.SinglePoint[0].Value = false;
+    ASSERT_EQ(buf.Add(objs), 3);
+
+    auto res = buf.Take();
+    ASSERT_EQ(res.MeasuredValueShort.size(), 2);
+    ASSERT_EQ(res.MeasuredValueShort[1].Address, 1);
+    ASSERT_EQ(res.MeasuredValueShort[1].Quality, IEC104::QUALITY_INVALID);
+    ASSERT_EQ(res.SinglePoint.size(), 1);
+    ASSERT_EQ(res.SinglePoint[0].Address, 1);
+    ASSERT_FALSE(res.SinglePoint[0].Value);
+}
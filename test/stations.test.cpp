@@ -0,0 +1,79 @@
+#include "stations.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace
+{
+    sCS101_AppLayerParameters AppLayerParameters = {1, 1, 2, 0, 2, 3, 249};
+}
+
+TEST(TStationsTest, CommonAddresses)
+{
+    // Objects of the default station can be listed too
+    IEC104::TStations stations(1, {{10, 3}, {11, 2}, {12, 3}, {13, 1}});
+    ASSERT_EQ(stations.GetCommonAddresses(), (std::vector<uint16_t>{1, 2, 3}));
+    ASSERT_EQ(stations.GetCommonAddress(1), 1);
+    ASSERT_EQ(stations.GetCommonAddress(10), 3);
+    ASSERT_EQ(stations.GetCommonAddress(11), 2);
+    ASSERT_EQ(stations.GetCommonAddress(13), 1);
+    ASSERT_TRUE(stations.HasStation(2));
+    ASSERT_FALSE(stations.HasStation(4));
+    ASSERT_FALSE(stations.HasStation(IEC104::BROADCAST_COMMON_ADDRESS));
+}
+
+TEST(TStationsTest, Split)
+{
+    IEC104::TInformationObjects objs;
+    objs.SinglePoint.emplace_back(1, true);
+    objs.SinglePoint.emplace_back(10, false);
+    objs.MeasuredValueShort.emplace_back(2, 1.5f);
+    objs.IntegratedTotals.emplace_back(11, 100, false);
+
+    // One station gets objects as is
+    IEC104::TStations single(5, {});
+    size_t calls = 0;
+    single.Split(objs, [&](uint16_t commonAddress, const IEC104::TInformationObjects& stationObjs) {
+        ASSERT_EQ(commonAddress, 5);
+        ASSERT_EQ(&stationObjs, &objs);
+        ++calls;
+    });
+    ASSERT_EQ(calls, 1);
+
+    // Stations without objects are skipped
+    IEC104::TStations stations(1, {{10, 2}, {11, 2}, {20, 3}});
+    std::map<uint16_t, IEC104::TInformationObjects> res;
+    stations.Split(objs, [&](uint16_t commonAddress, const IEC104::TInformationObjects& stationObjs) {
+        res[commonAddress] = stationObjs;
+    });
+    ASSERT_EQ(res.size(), 2);
+    ASSERT_EQ(res[1].SinglePoint.size(), 1);
+    ASSERT_EQ(res[1].SinglePoint[0].Address, 1);
+    ASSERT_EQ(res[1].MeasuredValueShort.size(), 1);
+    ASSERT_TRUE(res[1].IntegratedTotals.empty());
+    ASSERT_EQ(res[2].SinglePoint.size(), 1);
+    ASSERT_EQ(res[2].SinglePoint[0].Address, 10);
+    ASSERT_TRUE(res[2].MeasuredValueShort.empty());
+    ASSERT_EQ(res[2].IntegratedTotals.size(), 1);
+}
+
+TEST(TStationsTest, Send)
+{
+    IEC104::TInformationObjects objs;
+    objs.SinglePoint.emplace_back(1, true);
+    objs.SinglePoint.emplace_back(10, false);
+    objs.SinglePoint.emplace_back(2, true);
+
+    IEC104::TStations stations(1, {{10, 2}});
+    std::map<int, std::vector<int>> res; // Maps common address to addresses of information objects
+    stations.Send(&AppLayerParameters, CS101_COT_SPONTANEOUS, objs, [&](CS101_ASDU asdu) {
+        EXPECT_EQ(CS101_ASDU_getCOT(asdu), CS101_COT_SPONTANEOUS);
+        for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); ++i) {
+            auto io = CS101_ASDU_getElement(asdu, i);
+            res[CS101_ASDU_getCA(asdu)].push_back(InformationObject_getObjectAddress(io));
+            InformationObject_destroy(io);
+        }
+    });
+    ASSERT_EQ(res, (std::map<int, std::vector<int>>{{1, {1, 2}}, {2, {10}}}));
+}
@@ -0,0 +1,33 @@
+#include "statistics.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(TStatisticsTest, Counter)
+{
+    TCounter counter;
+    ASSERT_EQ(counter.Get(), 0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 16; ++i) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 1000; ++j) {
+                counter.Add();
+            }
+            counter.Add(10);
+        });
+    }
+    for (auto& t: threads) {
+        t.join();
+    }
+    ASSERT_EQ(counter.Get(), 16 * 1010);
+}
+
+TEST(TStatisticsTest, Gauge)
+{
+    TGauge gauge;
+    gauge.Add(2);
+    gauge.Add(-1);
+    ASSERT_EQ(gauge.Get(), 1);
+}
@@ -0,0 +1,65 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+namespace
+{
+    const auto START = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+
+    std::vector<size_t> Advance(TTimerWheel& wheel, const TTimerWheel::TTimePoint& now)
+    {
+        std::vector<size_t> expired{100}; // Stale content is cleared by the wheel
+        wheel.Advance(now, expired);
+        return expired;
+    }
+
+    std::vector<size_t> Sorted(std::vector<size_t> ids)
+    {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+}
+
+TEST(TTimerWheelTest, Expiration)
+{
+    TTimerWheel wheel(8, std::chrono::seconds(1), START);
+    wheel.Add(1, START + std::chrono::milliseconds(500));
+    wheel.Add(2, START + std::chrono::milliseconds(2500));
+    wheel.Add(3, START + std::chrono::seconds(3));
+    ASSERT_EQ(wheel.Size(), 3);
+
+    ASSERT_TRUE(Advance(wheel, START + std::chrono::milliseconds(900)).empty());
+    ASSERT_EQ(Advance(wheel, START + std::chrono::seconds(1)), std::vector<size_t>{1});
+    ASSERT_TRUE(Advance(wheel, START + std::chrono::milliseconds(2900)).empty());
+    ASSERT_EQ(Advance(wheel, START + std::chrono::seconds(3)), std::vector<size_t>{2});
+    ASSERT_EQ(Advance(wheel, START + std::chrono::seconds(4)), std::vector<size_t>{3});
+    ASSERT_EQ(wheel.Size(), 0);
+}
+
+TEST(TTimerWheelTest, LongTimeout)
+{
+    TTimerWheel wheel(4, std::chrono::seconds(1), START);
+    wheel.Add(1, START + std::chrono::milliseconds(10500));
+    wheel.Add(2, START - std::chrono::seconds(1));
+
+    ASSERT_EQ(Advance(wheel, START + std::chrono::seconds(4)), std::vector<size_t>{2});
+    ASSERT_TRUE(Advance(wheel, START + std::chrono::seconds(10)).empty());
+    ASSERT_EQ(wheel.Size(), 1);
+    ASSERT_EQ(Advance(wheel, START + std::chrono::seconds(11)), std::vector<size_t>{1});
+}
+
+TEST(TTimerWheelTest, Jump)
+{
+    TTimerWheel wheel(4, std::chrono::seconds(1), START);
+    for (size_t i = 0; i < 6; ++i) {
+        wheel.Add(i, START + std::chrono::seconds(i));
+    }
+    // All timers expire at once if the wheel is advanced over several turns
+    ASSERT_EQ(Sorted(Advance(wheel, START + std::chrono::seconds(20))), (std::vector<size_t>{0, 1, 2, 3, 4, 5}));
+
+    // New timers are scheduled relative to current time of the wheel
+    wheel.Add(7, START + std::chrono::seconds(21));
+    ASSERT_TRUE(Advance(wheel, START + std::chrono::milliseconds(20500)).empty());
+    ASSERT_EQ(Advance(wheel, START + std::chrono::seconds(22)), std::vector<size_t>{7});
+}
@@ -0,0 +1,45 @@
+#include "value_formatter.h"
+#include "value_parser.h"
+
+#include <gtest/gtest.h>
+#include <limits>
+
+using namespace ValueFormatter;
+
+namespace
+{
+    std::string Int(int64_t value)
+    {
+        char buf[MAX_SIZE];
+        return std::string(buf, FormatInt(value, buf));
+    }
+
+    std::string Float(float value)
+    {
+        char buf[MAX_SIZE];
+        return std::string(buf, FormatFloat(value, buf));
+    }
+}
+
+TEST(TValueFormatterTest, Int)
+{
+    ASSERT_EQ(Int(0), "0");
+    ASSERT_EQ(Int(-15), "-15");
+    ASSERT_EQ(Int(4294967295), "4294967295");
+    ASSERT_EQ(Int(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+}
+
+TEST(TValueFormatterTest, Float)
+{
+    ASSERT_EQ(Float(0), "0");
+    ASSERT_EQ(Float(10.21f), "10.21");
+    ASSERT_EQ(Float(-0.5f), "-0.5");
+    ASSERT_EQ(Float(1e20f), "1e+20");
+
+    // Formatted values are parsed back to the same floats
+    for (float value: {0.1f, 1.0f / 3, -123456.789f, 1e38f, 1e-30f}) {
+        float res;
+        ASSERT_EQ(ValueParser::ParseFloat(Float(value), res), TParseResult::Ok) << Float(value);
+        ASSERT_EQ(res, value) << Float(value);
+    }
+}
@@ -0,0 +1,59 @@
+#include "value_parser.h"
+
+#include <gtest/gtest.h>
+
+using namespace ValueParser;
+
+TEST(TValueParserTest, Bool)
+{
+    bool v = false;
+    ASSERT_EQ(ParseBool("1", v), TParseResult::Ok);
+    ASSERT_TRUE(v);
+    ASSERT_EQ(ParseBool(" 0 ", v), TParseResult::Ok);
+    ASSERT_FALSE(v);
+    ASSERT_EQ(ParseBool("", v), TParseResult::Empty);
+    ASSERT_EQ(ParseBool("2", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseBool("10", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseBool("true", v), TParseResult::Invalid);
+}
+
+TEST(TValueParserTest, Int)
+{
+    int32_t v = 0;
+    ASSERT_EQ(ParseInt("123", v), TParseResult::Ok);
+    ASSERT_EQ(v, 123);
+    ASSERT_EQ(ParseInt("+17", v), TParseResult::Ok);
+    ASSERT_EQ(v, 17);
+    ASSERT_EQ(ParseInt("-2147483648", v), TParseResult::Ok);
+    ASSERT_EQ(v, -2147483648);
+    ASSERT_EQ(ParseInt("-12.9", v), TParseResult::Ok);
+    ASSERT_EQ(v, -12);
+    ASSERT_EQ(ParseInt("1e3", v), TParseResult::Ok);
+    ASSERT_EQ(v, 1000);
+
+    ASSERT_EQ(ParseInt("  ", v), TParseResult::Empty);
+    ASSERT_EQ(ParseInt("12a", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseInt("+-1", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseInt("bad", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseInt("2147483648", v), TParseResult::OutOfRange);
+    ASSERT_EQ(ParseInt("1e10", v), TParseResult::OutOfRange);
+    ASSERT_EQ(v, 1000);
+}
+
+TEST(TValueParserTest, Float)
+{
+    float v = 0;
+    ASSERT_EQ(ParseFloat("1.5", v), TParseResult::Ok);
+    ASSERT_EQ(v, 1.5f);
+    ASSERT_EQ(ParseFloat("-2.5e2\n", v), TParseResult::Ok);
+    ASSERT_EQ(v, -250.0f);
+    ASSERT_EQ(ParseFloat("1e39", v), TParseResult::OutOfRange);
+    ASSERT_EQ(ParseFloat("1,5", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseFloat("0x10", v), TParseResult::Invalid);
+    ASSERT_EQ(ParseFloat("", v), TParseResult::Empty);
+
+    double d = 0;
+    ASSERT_EQ(ParseDouble("12345678.125", d), TParseResult::Ok);
+    ASSERT_EQ(d, 12345678.125);
+    ASSERT_EQ(ParseDouble("1e400", d), TParseResult::OutOfRange);
+}